@@ -48,14 +48,57 @@ struct _CRSelEngPriv {
 
         CRNodeIface const *node_iface;
         CRStyleSheet *sheet;
+        GList *pcs_handlers;
+        gint pcs_handlers_size;
+
         /**
-         *where to store the next statement
-         *to be visited so that we can remember
+         *The candidate selectors of the current sheet for
+         *the node being matched, and where to resume
+         *the evaluation so that we can remember
          *it from one method call to another.
          */
-        CRStatement *cur_stmt;
-        GList *pcs_handlers;
-        gint pcs_handlers_size;
+        CRXMLNodePtr cur_node;
+        GPtrArray *candidates;
+        guint cur_candidate;
+} ;
+
+/**
+ *One selector of a ruleset, as seen by the selector index.
+ */
+typedef struct _CRSelIndexEntry CRSelIndexEntry;
+struct _CRSelIndexEntry {
+        CRStatement *stmt;
+        CRSimpleSel *simple_sel;
+        /*position of the selector in the stylesheet, for cascade order*/
+        guint seq;
+};
+
+/**
+ *Selectors of a stylesheet bucketed by the id, class or element
+ *name that the rightmost compound selector requires. Selectors that
+ *have none of these (universal, attribute or pseudo class only)
+ *are kept in a separate list and are tried against every node.
+ *
+ *The index is only a prefilter: each candidate is still evaluated
+ *with sel_matches_node_real(), so a selector put in a bucket it
+ *cannot match in is harmless, but it must never be left out of
+ *a bucket it can match in.
+ */
+typedef struct _CRSelIndex CRSelIndex;
+struct _CRSelIndex {
+        /*first and last statements and generation of the sheet at
+         *build time, to detect changes*/
+        CRStatement *first_stmt;
+        CRStatement *last_stmt;
+        gulong generation;
+
+        CRSelIndexEntry *entries;
+        guint nb_entries;
+
+        GHashTable *by_id;
+        GHashTable *by_class;
+        GHashTable *by_name;
+        GPtrArray *universal;
 } ;
 
 static gboolean class_add_sel_matches_node (CRAdditionalSel * a_add_sel,
@@ -82,6 +125,14 @@ static enum CRStatus cr_sel_eng_get_matched_rulesets_real (CRSelEng * a_this,
                                                            a_rulesets,
                                                            gulong * a_len);
 
+static CRSelIndex *sel_index_get (CRStyleSheet * a_sheet);
+
+static void sel_index_destroy (gpointer a_index);
+
+static GPtrArray *sel_index_lookup (CRSelIndex * a_index,
+                                    CRNodeIface const * a_node_iface,
+                                    CRXMLNodePtr a_node);
+
 static enum CRStatus put_css_properties_in_props_list (CRPropList ** a_props,
                                                        CRStatement *
                                                        a_ruleset);
@@ -1411,13 +1462,293 @@ sel_matches_node_real (CRSelEng * a_this, CRSimpleSel * a_sel,
 }
 
 
+/**
+ *@param a_stmt the statement to consider.
+ *@return the comma separated selector list of a ruleset
+ *(or of the first ruleset of a \@media rule), NULL if the
+ *statement has none.
+ */
+static CRSelector *
+get_stmt_sel_list (CRStatement * a_stmt)
+{
+        switch (a_stmt->type) {
+        case RULESET_STMT:
+                if (a_stmt->kind.ruleset) {
+                        return a_stmt->kind.ruleset->sel_list;
+                }
+                break;
+
+        case AT_MEDIA_RULE_STMT:
+                if (a_stmt->kind.media_rule
+                    && a_stmt->kind.media_rule->rulesets
+                    && a_stmt->kind.media_rule->rulesets->kind.ruleset) {
+                        return a_stmt->kind.media_rule->rulesets->
+                                kind.ruleset->sel_list;
+                }
+                break;
+
+        case AT_IMPORT_RULE_STMT:
+                /*
+                 *some recursivity may be needed here.
+                 *I don't like this :(
+                 */
+                break;
+        default:
+                break;
+        }
+        return NULL;
+}
+
+static gboolean
+crstring_is_set (CRString const * a_str)
+{
+        return a_str && a_str->stryng && a_str->stryng->str
+                && a_str->stryng->len;
+}
+
+static void
+sel_index_add (GHashTable * a_table, gchar const * a_key,
+               CRSelIndexEntry * a_entry)
+{
+        GPtrArray *bucket = (GPtrArray *) g_hash_table_lookup (a_table, a_key);
+
+        if (!bucket) {
+                bucket = g_ptr_array_new ();
+                g_hash_table_insert (a_table, (gpointer) a_key, bucket);
+        }
+        g_ptr_array_add (bucket, a_entry);
+}
+
+/**
+ *Puts an entry in the bucket of the rightmost compound selector
+ *of its selector: id first, then class, then element name.
+ */
+static void
+sel_index_insert (CRSelIndex * a_index, CRSelIndexEntry * a_entry)
+{
+        CRSimpleSel *subject = NULL;
+        CRAdditionalSel *add_sel = NULL;
+        CRString *id = NULL,
+                *klass = NULL;
+
+        for (subject = a_entry->simple_sel;
+             subject && subject->next; subject = subject->next) ;
+
+        for (add_sel = subject->add_sel; add_sel; add_sel = add_sel->next) {
+                if (add_sel->type == ID_ADD_SELECTOR
+                    && crstring_is_set (add_sel->content.id_name)) {
+                        id = add_sel->content.id_name;
+                        break;
+                }
+                if (!klass && add_sel->type == CLASS_ADD_SELECTOR
+                    && crstring_is_set (add_sel->content.class_name)) {
+                        klass = add_sel->content.class_name;
+                }
+        }
+
+        if (id) {
+                sel_index_add (a_index->by_id, id->stryng->str, a_entry);
+        } else if (klass) {
+                sel_index_add (a_index->by_class, klass->stryng->str, a_entry);
+        } else if ((subject->type_mask & TYPE_SELECTOR)
+                   && !(subject->type_mask & UNIVERSAL_SELECTOR)
+                   && crstring_is_set (subject->name)) {
+                sel_index_add (a_index->by_name, subject->name->stryng->str,
+                               a_entry);
+        } else {
+                g_ptr_array_add (a_index->universal, a_entry);
+        }
+}
+
+static CRSelIndex *
+sel_index_build (CRStyleSheet * a_sheet)
+{
+        CRSelIndex *result = NULL;
+        CRStatement *cur_stmt = NULL;
+        CRSelector *cur_sel = NULL;
+        guint nb_entries = 0;
+
+        result = g_new0 (CRSelIndex, 1);
+        result->first_stmt = a_sheet->statements;
+        result->generation = a_sheet->statements_generation;
+        result->by_id = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                               (GDestroyNotify) g_ptr_array_unref);
+        result->by_class = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                                  (GDestroyNotify) g_ptr_array_unref);
+        result->by_name = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                                 (GDestroyNotify) g_ptr_array_unref);
+        result->universal = g_ptr_array_new ();
+
+        for (cur_stmt = a_sheet->statements; cur_stmt; cur_stmt = cur_stmt->next) {
+                for (cur_sel = get_stmt_sel_list (cur_stmt); cur_sel; cur_sel = cur_sel->next) {
+                        if (cur_sel->simple_sel)
+                                nb_entries++;
+                }
+                result->last_stmt = cur_stmt;
+        }
+
+        result->entries = g_new0 (CRSelIndexEntry, nb_entries ? nb_entries : 1);
+
+        for (cur_stmt = a_sheet->statements; cur_stmt; cur_stmt = cur_stmt->next) {
+                for (cur_sel = get_stmt_sel_list (cur_stmt); cur_sel; cur_sel = cur_sel->next) {
+                        CRSelIndexEntry *entry = NULL;
+
+                        if (!cur_sel->simple_sel)
+                                continue;
+                        entry = &result->entries[result->nb_entries];
+                        entry->stmt = cur_stmt;
+                        entry->simple_sel = cur_sel->simple_sel;
+                        entry->seq = result->nb_entries++;
+                        sel_index_insert (result, entry);
+                }
+        }
+
+        return result;
+}
+
+static void
+sel_index_destroy (gpointer a_index)
+{
+        CRSelIndex *index = (CRSelIndex *) a_index;
+
+        g_return_if_fail (index);
+
+        g_hash_table_destroy (index->by_id);
+        g_hash_table_destroy (index->by_class);
+        g_hash_table_destroy (index->by_name);
+        g_ptr_array_free (index->universal, TRUE);
+        g_free (index->entries);
+        g_free (index);
+}
+
+/**
+ *Returns the selector index of a stylesheet, building it on first
+ *use. The index is rebuilt when statements of the sheet were
+ *appended, prepended or unlinked, or its statement list was
+ *replaced since it was built.
+ */
+static CRSelIndex *
+sel_index_get (CRStyleSheet * a_sheet)
+{
+        CRSelIndex *index = (CRSelIndex *) a_sheet->sel_index;
+
+        if (index
+            && index->generation == a_sheet->statements_generation
+            && index->first_stmt == a_sheet->statements
+            && (!index->last_stmt || !index->last_stmt->next)) {
+                return index;
+        }
+
+        if (index && a_sheet->sel_index_destroy) {
+                a_sheet->sel_index_destroy (index);
+        }
+        index = sel_index_build (a_sheet);
+        a_sheet->sel_index = index;
+        a_sheet->sel_index_destroy = sel_index_destroy;
+        return index;
+}
+
+static void
+sel_index_collect (GPtrArray * a_result, GPtrArray const * a_bucket)
+{
+        guint i = 0;
+
+        if (!a_bucket)
+                return;
+        for (i = 0; i < a_bucket->len; i++) {
+                g_ptr_array_add (a_result, g_ptr_array_index (a_bucket, i));
+        }
+}
+
+static gint
+sel_index_entry_compare (gconstpointer a_a, gconstpointer a_b)
+{
+        CRSelIndexEntry const *a = *(CRSelIndexEntry * const *) a_a;
+        CRSelIndexEntry const *b = *(CRSelIndexEntry * const *) a_b;
+
+        return (a->seq > b->seq) - (a->seq < b->seq);
+}
+
+/**
+ *@return the index entries that may match a_node, in stylesheet
+ *order. The caller owns the returned array.
+ */
+static GPtrArray *
+sel_index_lookup (CRSelIndex * a_index, CRNodeIface const * a_node_iface,
+                  CRXMLNodePtr a_node)
+{
+        GPtrArray *result = g_ptr_array_new ();
+        char const *name = NULL;
+        char *id = NULL,
+                *klass = NULL;
+
+        if (!a_node_iface->isElementNode (a_node))
+                return result;
+
+        sel_index_collect (result, a_index->universal);
+
+        name = a_node_iface->getLocalName (a_node);
+        if (name) {
+                sel_index_collect (result, (GPtrArray *) g_hash_table_lookup
+                                   (a_index->by_name, name));
+        }
+
+        id = a_node_iface->getProp (a_node, "id");
+        if (id) {
+                sel_index_collect (result, (GPtrArray *) g_hash_table_lookup
+                                   (a_index->by_id, id));
+                a_node_iface->freePropVal (id);
+        }
+
+        klass = a_node_iface->getProp (a_node, "class");
+        if (klass) {
+                char *cur = klass,
+                        *token = NULL;
+
+                while (*cur) {
+                        while (*cur && cr_utils_is_white_space (*cur) == TRUE)
+                                cur++;
+                        if (!*cur)
+                                break;
+                        token = cur;
+                        while (*cur && cr_utils_is_white_space (*cur) == FALSE)
+                                cur++;
+                        if (*cur)
+                                *cur++ = '\0';
+                        sel_index_collect (result, (GPtrArray *) g_hash_table_lookup
+                                           (a_index->by_class, token));
+                }
+                a_node_iface->freePropVal (klass);
+        }
+
+        /*restore stylesheet order, dropping repeats from duplicate classes*/
+        if (result->len > 1) {
+                guint i = 0,
+                        j = 1;
+
+                g_ptr_array_sort (result, sel_index_entry_compare);
+                for (i = 1; i < result->len; i++) {
+                        if (g_ptr_array_index (result, i)
+                            != g_ptr_array_index (result, j - 1)) {
+                                g_ptr_array_index (result, j++) =
+                                        g_ptr_array_index (result, i);
+                        }
+                }
+                g_ptr_array_set_size (result, j);
+        }
+
+        return result;
+}
+
 /**
  *Returns  array of the ruleset statements that matches the
  *given xml node.
- *The engine keeps in memory the last statement he
+ *Only the selectors that the stylesheet's selector index gives as
+ *candidates for the node are evaluated.
+ *The engine keeps in memory the last candidate he
  *visited during the match. So, the next call
  *to this function will eventually return a rulesets list starting
- *from the last ruleset statement visited during the previous call.
+ *from the last candidate visited during the previous call.
  *The enable users to get matching rulesets in an incremental way.
  *Note that for each statement returned, 
  *the engine calculates the specificity of the selector
@@ -1455,9 +1786,8 @@ cr_sel_eng_get_matched_rulesets_real (CRSelEng * a_this,
                                       CRStatement ** a_rulesets,
                                       gulong * a_len)
 {
-        CRStatement *cur_stmt = NULL;
-        CRSelector *sel_list = NULL,
-                *cur_sel = NULL;
+        CRSelIndexEntry *entry = NULL;
+        GPtrArray *candidates = NULL;
         gboolean matches = FALSE;
         enum CRStatus status = CR_OK;
         gulong i = 0;
@@ -1473,124 +1803,81 @@ cr_sel_eng_get_matched_rulesets_real (CRSelEng * a_this,
         }
 
         /*
-         *if this stylesheet is "new one"
-         *let's remember it for subsequent calls.
+         *if this stylesheet or node is a "new one"
+         *let's look up its candidates and remember them
+         *for subsequent calls.
          */
-        if (PRIVATE (a_this)->sheet != a_stylesheet) {
+        if (PRIVATE (a_this)->sheet != a_stylesheet
+            || PRIVATE (a_this)->cur_node != a_node) {
+                if (PRIVATE (a_this)->candidates) {
+                        g_ptr_array_free (PRIVATE (a_this)->candidates, TRUE);
+                }
                 PRIVATE (a_this)->sheet = a_stylesheet;
-                PRIVATE (a_this)->cur_stmt = a_stylesheet->statements;
+                PRIVATE (a_this)->cur_node = a_node;
+                PRIVATE (a_this)->candidates = sel_index_lookup
+                        (sel_index_get (a_stylesheet),
+                         PRIVATE (a_this)->node_iface, a_node);
+                PRIVATE (a_this)->cur_candidate = 0;
         }
+        candidates = PRIVATE (a_this)->candidates;
 
         /*
-         *walk through the list of statements and,
-         *get the selectors list inside the statements that
-         *contain some, and try to match our xml node in these
-         *selectors lists.
+         *walk through the candidate selectors, and
+         *try to match our xml node against each of them.
          */
-        for (cur_stmt = PRIVATE (a_this)->cur_stmt, i = 0;
-             (PRIVATE (a_this)->cur_stmt = cur_stmt);
-             cur_stmt = cur_stmt->next) {
-                /*
-                 *initialyze the selector list in which we will
-                 *really perform the search.
-                 */
-                sel_list = NULL;
-
-                /*
-                 *get the damn selector list in 
-                 *which we have to look
-                 */
-                switch (cur_stmt->type) {
-                case RULESET_STMT:
-                        if (cur_stmt->kind.ruleset
-                            && cur_stmt->kind.ruleset->sel_list) {
-                                sel_list = cur_stmt->kind.ruleset->sel_list;
-                        }
-                        break;
+        for (i = 0;
+             PRIVATE (a_this)->cur_candidate < candidates->len;
+             PRIVATE (a_this)->cur_candidate++) {
+                entry = (CRSelIndexEntry *) g_ptr_array_index
+                        (candidates, PRIVATE (a_this)->cur_candidate);
 
-                case AT_MEDIA_RULE_STMT:
-                        if (cur_stmt->kind.media_rule
-                            && cur_stmt->kind.media_rule->rulesets
-                            && cur_stmt->kind.media_rule->rulesets->
-                            kind.ruleset
-                            && cur_stmt->kind.media_rule->rulesets->
-                            kind.ruleset->sel_list) {
-                                sel_list =
-                                        cur_stmt->kind.media_rule->
-                                        rulesets->kind.ruleset->sel_list;
-                        }
-                        break;
+                status = cr_sel_eng_matches_node
+                        (a_this, entry->simple_sel, a_node, &matches);
 
-                case AT_IMPORT_RULE_STMT:
+                if (status == CR_OK && matches == TRUE) {
                         /*
-                         *some recursivity may be needed here.
-                         *I don't like this :(
+                         *bingo!!! we found one ruleset that
+                         *matches that fucking node.
+                         *lets put it in the out array.
                          */
-                        break;
-                default:
-                        break;
-                }
 
-                if (!sel_list)
-                        continue;
+                        if (i < *a_len) {
+                                a_rulesets[i] = entry->stmt;
+                                i++;
 
-                /*
-                 *now, we have a comma separated selector list to look in.
-                 *let's walk it and try to match the xml_node
-                 *on each item of the list.
-                 */
-                for (cur_sel = sel_list; cur_sel; cur_sel = cur_sel->next) {
-                        if (!cur_sel->simple_sel)
-                                continue;
-
-                        status = cr_sel_eng_matches_node
-                                (a_this, cur_sel->simple_sel,
-                                 a_node, &matches);
-
-                        if (status == CR_OK && matches == TRUE) {
                                 /*
-                                 *bingo!!! we found one ruleset that
-                                 *matches that fucking node.
-                                 *lets put it in the out array.
+                                 *For the cascade computing algorithm
+                                 *(which is gonna take place later)
+                                 *we must compute the specificity
+                                 *(css2 spec chap 6.4.1) of the selector
+                                 *that matched the current xml node
+                                 *and store it in the css2 statement
+                                 *(statement == ruleset here).
                                  */
+                                status = cr_simple_sel_compute_specificity (entry->simple_sel);
 
-                                if (i < *a_len) {
-                                        a_rulesets[i] = cur_stmt;
-                                        i++;
-
-                                        /*
-                                         *For the cascade computing algorithm
-                                         *(which is gonna take place later)
-                                         *we must compute the specificity
-                                         *(css2 spec chap 6.4.1) of the selector
-                                         *that matched the current xml node
-                                         *and store it in the css2 statement
-                                         *(statement == ruleset here).
-                                         */
-                                        status = cr_simple_sel_compute_specificity (cur_sel->simple_sel);
-
-                                        g_return_val_if_fail (status == CR_OK,
-                                                              CR_ERROR);
-                                        cur_stmt->specificity =
-                                                cur_sel->simple_sel->
-                                                specificity;
-                                } else
-                                {
-                                        *a_len = i;
-                                        return CR_OUTPUT_TOO_SHORT_ERROR;
-                                }
+                                g_return_val_if_fail (status == CR_OK,
+                                                      CR_ERROR);
+                                entry->stmt->specificity =
+                                        entry->simple_sel->specificity;
+                        } else
+                        {
+                                *a_len = i;
+                                return CR_OUTPUT_TOO_SHORT_ERROR;
                         }
                 }
         }
 
         /*
          *if we reached this point, it means
-         *we reached the end of stylesheet.
+         *we reached the end of the candidates.
          *no need to store any info about the stylesheet
          *anymore.
          */
-        g_return_val_if_fail (!PRIVATE (a_this)->cur_stmt, CR_ERROR);
+        g_ptr_array_free (PRIVATE (a_this)->candidates, TRUE);
+        PRIVATE (a_this)->candidates = NULL;
         PRIVATE (a_this)->sheet = NULL;
+        PRIVATE (a_this)->cur_node = NULL;
         *a_len = i;
         return CR_OK;
 }
@@ -2285,6 +2572,10 @@ cr_sel_eng_destroy (CRSelEng * a_this)
                         (a_this) ;
                 PRIVATE (a_this)->pcs_handlers = NULL ;
         }
+        if (PRIVATE (a_this)->candidates) {
+                g_ptr_array_free (PRIVATE (a_this)->candidates, TRUE);
+                PRIVATE (a_this)->candidates = NULL;
+        }
         g_free (PRIVATE (a_this));
         PRIVATE (a_this) = NULL;
  end:
@@ -34,6 +34,8 @@
 
 static void cr_statement_clear (CRStatement * a_this);
 
+static void cr_statement_changed_sheet (CRStatement * a_this);
+
 static void  
 parse_font_face_start_font_face_cb (CRDocHandler * a_this,
                                     CRParsingLocation *a_location)
@@ -1849,6 +1851,9 @@ cr_statement_append (CRStatement * a_this, CRStatement * a_new)
         cur->next = a_new;
         a_new->prev = cur;
 
+        cr_statement_changed_sheet (a_this);
+        cr_statement_changed_sheet (a_new);
+
         return a_this;
 }
 
@@ -1877,6 +1882,9 @@ cr_statement_prepend (CRStatement * a_this, CRStatement * a_new)
         a_new->next = a_this;
         a_this->prev = a_new;
 
+        cr_statement_changed_sheet (a_this);
+        cr_statement_changed_sheet (a_new);
+
         /*walk backward in the prepended list to find the head list element */
         for (cur = a_new; cur && cur->prev; cur = cur->prev) ;
 
@@ -1911,6 +1919,8 @@ cr_statement_unlink (CRStatement * a_stmt)
                 g_return_val_if_fail (a_stmt->prev->next == a_stmt, NULL);
         }
 
+        cr_statement_changed_sheet (a_stmt);
+
         /**
          *Now, the real unlinking job.
          */
@@ -1934,6 +1944,18 @@ cr_statement_unlink (CRStatement * a_stmt)
         return result;
 }
 
+/**
+ *Tells the stylesheet of a statement, if it has one, that its
+ *list of statements changed.
+ */
+static void
+cr_statement_changed_sheet (CRStatement * a_this)
+{
+        if (a_this && a_this->parent_sheet) {
+                a_this->parent_sheet->statements_generation++;
+        }
+}
+
 /**
  * cr_statement_nr_rules:
  *
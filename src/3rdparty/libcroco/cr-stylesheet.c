@@ -295,6 +295,11 @@ cr_stylesheet_destroy (CRStyleSheet * a_this)
 {
         g_return_if_fail (a_this);
 
+        if (a_this->sel_index && a_this->sel_index_destroy) {
+                a_this->sel_index_destroy (a_this->sel_index);
+                a_this->sel_index = NULL;
+        }
+
         if (a_this->statements) {
                 cr_statement_destroy (a_this->statements);
                 a_this->statements = NULL;
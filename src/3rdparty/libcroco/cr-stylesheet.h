@@ -96,6 +96,20 @@ struct _CRStyleSheet
          * A link to the previous stylesheet.
          */
         CRStyleSheet *prev;
+
+        /**
+         * Selector index built lazily by the selection engine
+         * (see cr-sel-eng.c) and the function used to free it.
+         */
+        gpointer sel_index;
+        GDestroyNotify sel_index_destroy;
+
+        /**
+         * Bumped when a statement of this sheet is appended,
+         * prepended or unlinked, so that the selector index
+         * can tell it is out of date.
+         */
+        gulong statements_generation;
 } ;
 
 CRStyleSheet * cr_stylesheet_new (CRStatement *a_stmts) ;
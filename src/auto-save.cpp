@@ -10,6 +10,8 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
@@ -23,7 +25,6 @@
 #include "inkscape-application.h"
 #include "preferences.h"
 
-#include "extension/output.h"
 #include "io/sys.h"
 #include "xml/repr.h"
 
@@ -62,15 +63,133 @@ AutoSave::start()
     }
 }
 
+/**
+ * An autosave in progress: documents serialised on the main thread, waiting
+ * to be written out by the worker thread.
+ */
+struct AutoSave::Job {
+    struct File {
+        SPDocument *document;
+        std::string path;
+        Glib::ustring data;
+        bool saved;
+    };
+
+    std::string autosave_dir;
+    std::string base_name;
+    int autosave_max;
+    std::vector<File> files;
+
+    void run();
+};
+
+/**
+ * Writes the serialised documents to disk. Runs on the worker thread: it must not
+ * touch the documents, the XML tree or the preferences.
+ */
+void
+AutoSave::Job::run()
+{
+    for (auto &file : files) {
+
+        // The following we do for each document (rather wasteful...) so that
+        // we make room for each document that needs saving. We probably should
+        // be counting per document and not overall documents.
+
+        // Open directory
+        Glib::Dir directory(autosave_dir);
+        std::vector<std::string> file_names(directory.begin(), directory.end());
+
+        // Sort them so that oldest are last (file name encodes time).
+        std::sort(file_names.begin(), file_names.end(), std::greater<std::string>());
+
+        // Delete oldest files.
+        int count = 0;
+        for (auto &file_name : file_names) {
+            if (file_name.compare(0, base_name.size(), base_name) == 0) {
+                ++count;
+                if (count >= autosave_max) {
+                    // Delete (making room for one more).
+                    std::string path = Glib::build_filename(autosave_dir, file_name);
+                    if (unlink(path.c_str()) == -1) {
+                        std::cerr << "InkscapeApplication::document_autosave: Failed to unlink file: "
+                                  << path << ": " << strerror(errno) << std::endl;
+                    }
+                }
+            }
+        }
+
+        // Try to save the file
+        FILE *fp = Inkscape::IO::fopen_utf8name(file.path.c_str(), "w");
+        if (fp) {
+            std::string const &data = file.data.raw();
+            file.saved = fwrite(data.data(), 1, data.size(), fp) == data.size();
+            file.saved = (fclose(fp) == 0) && file.saved;
+        }
+
+        if (!file.saved) {
+            gchar *safeUri = Inkscape::IO::sanitizeString(file.path.c_str());
+            gchar *errortext = g_strdup_printf(_("Autosave failed! File %s could not be saved."), safeUri);
+            g_warning("%s", errortext);
+            g_free(errortext);
+            g_free(safeUri);
+        }
+    }
+}
+
+AutoSave::~AutoSave()
+{
+    if (_worker.joinable()) {
+        _worker.join();
+    }
+}
+
+/**
+ * Picks up the result of the previous autosave once its worker has finished.
+ * Documents that could not be written are marked for the next autosave.
+ */
+void
+AutoSave::collect()
+{
+    if (!_worker.joinable()) {
+        return;
+    }
+    _worker.join();
+
+    std::vector<SPDocument *> documents = _app->get_documents();
+    for (auto &file : _job->files) {
+        if (!file.saved && std::find(documents.begin(), documents.end(), file.document) != documents.end()) {
+            file.document->setModifiedSinceAutoSaveTrue();
+        }
+    }
+    _job.reset();
+}
+
+/**
+ * Takes a snapshot of each modified document and hands it to a worker thread.
+ *
+ * The XML tree cannot be read off the main thread (nodes live on the garbage
+ * collected heap, which knows nothing of other threads), so the snapshot is the
+ * serialised document in memory. Everything involving the file system is left
+ * to the worker.
+ */
 bool
 AutoSave::save()
 {
+    if (!_worker_done) {
+        // The previous autosave is still being written. Try again next time.
+        return true;
+    }
+    collect();
+
     std::vector<SPDocument *> documents = _app->get_documents();
     if (documents.empty()) {
         // Nothing to save!
         return true;
     }
 
+    auto const start_time = std::chrono::steady_clock::now();
+
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
 
     // Find/create autosave directory
@@ -97,43 +216,18 @@ AutoSave::save()
     std::stringstream ss;
     ss << std::put_time(&tm, "%Y_%m_%d_%H_%M_%S");
 
+    std::unique_ptr<Job> job(new Job());
+    job->autosave_dir = autosave_dir;
+    job->base_name = "inkscape-autosave-" + std::to_string(uid);
+    job->autosave_max = prefs->getInt("/options/autosave/max", 10);
+
     int docnum = 0;
-    int autosave_max = prefs->getInt("/options/autosave/max", 10);
     for (auto document : documents) {
 
         ++docnum; // Give each document a unique number.
 
         if (document->isModifiedSinceAutoSave()) {
 
-            std::string base_name = "inkscape-autosave-" + std::to_string(uid);
-
-            // The following we do for each document (rather wasteful...) so that
-            // we make room for each document that needs saving. We probably should
-            // be counting per document and not overall documents.
-
-            // Open directory
-            Glib::Dir directory(autosave_dir);
-            std::vector<std::string> file_names(directory.begin(), directory.end());
-
-            // Sort them so that oldest are last (file name encodes time).
-            std::sort(file_names.begin(), file_names.end(), std::greater<std::string>());
-
-            // Delete oldest files.
-            int count = 0;
-            for (auto &file_name : file_names) {
-                if (file_name.compare(0, base_name.size(), base_name) == 0) {
-                    ++count;
-                    if (count >= autosave_max) {
-                        // Delete (making room for one more).
-                        std::string path = Glib::build_filename(autosave_dir, file_name);
-                        if (unlink(path.c_str()) == -1) {
-                            std::cerr << "InkscapeApplication::document_autosave: Failed to unlink file: "
-                                      << path << ": " << strerror(errno) << std::endl;
-                        }
-                    }
-                }
-            }
-
             // Construct save file path
             std::stringstream ssf;
             ssf << "inkscape-autosave-"
@@ -144,37 +238,26 @@ AutoSave::save()
                 << ".svg";
             std::string path = Glib::build_filename(autosave_dir, ssf.str());
 
-            // Try to save the file
-            // Following code needs to be reviewed
-            FILE *file = Inkscape::IO::fopen_utf8name(path.c_str(), "w");
-            gchar *errortext = nullptr;
-            if (file) {
-                try {
-                    Inkscape::XML::Node *repr = document->getReprRoot();
-                    sp_repr_save_stream(repr->document(), file, SP_SVG_NS_URI);
-                } catch (Inkscape::Extension::Output::no_extension_found &e) {
-                    errortext = g_strdup(_("Autosave failed! Could not find inkscape extension to save document."));
-                } catch (Inkscape::Extension::Output::save_failed &e) {
-                    gchar *safeUri = Inkscape::IO::sanitizeString(path.c_str());
-                    errortext = g_strdup_printf(_("Autosave failed! File %s could not be saved."), safeUri);
-                    g_free(safeUri);
-                }
-                fclose(file);
-            } else {
-                gchar *safeUri = Inkscape::IO::sanitizeString(path.c_str());
-                errortext = g_strdup_printf(_("Autosave failed! File %s could not be saved."), safeUri);
-                g_free(safeUri);
-            }
+            Glib::ustring data = sp_repr_save_buf(document->getReprDoc(), SP_SVG_NS_URI);
+            job->files.push_back({document, path, std::move(data), false});
 
-            if (errortext) {
-                g_warning("%s", errortext);
-                g_free(errortext);
-            } else {
-                document->setModifiedSinceAutoSaveFalse();
-            }
+            // Changes from here on go into the next autosave.
+            document->setModifiedSinceAutoSaveFalse();
         }
     } // Loop over documents
 
+    if (!job->files.empty()) {
+        _job = std::move(job);
+        _worker_done = false;
+        _worker = std::thread([this] {
+            _job->run();
+            _worker_done = true;
+        });
+    }
+
+    _main_thread_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time);
+    g_debug("AutoSave::save: %ld us on the main thread", static_cast<long>(_main_thread_time.count()));
+
     return true;
 }
 
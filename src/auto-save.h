@@ -13,6 +13,11 @@
 #ifndef INKSCAPE_AUTOSAVE_H
 #define INKSCAPE_AUTOSAVE_H
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
 class InkscapeApplication;
 
 namespace Inkscape {
@@ -27,6 +32,8 @@ public:
     AutoSave(AutoSave &&) = delete;
     AutoSave &operator=(AutoSave &&) = delete;
 
+    ~AutoSave();
+
     static AutoSave &getInstance()
     {
         static AutoSave theInstance;
@@ -38,8 +45,19 @@ public:
     void start(); // Includes restarting.
     bool save();
 
+    /// Time the last autosave blocked the main thread for.
+    std::chrono::microseconds getMainThreadTime() const { return _main_thread_time; }
+
 private:
+    struct Job;
+
+    void collect();
+
     InkscapeApplication* _app = nullptr;
+    std::unique_ptr<Job> _job;
+    std::thread _worker;
+    std::atomic<bool> _worker_done{true};
+    std::chrono::microseconds _main_thread_time{0};
 };
 
 } // namespace Inkscape
@@ -102,6 +102,18 @@ CompositeUndoStackObserver::notifyClearRedoEvent()
 	this->_unlock();
 }
 
+void
+CompositeUndoStackObserver::notifyUndoExpiredEvent(Event* log)
+{
+	this->_lock();
+	for(UndoObserverRecordList::iterator i = this->_active.begin(); i != _active.end(); ++i) {
+		if (!i->to_remove) {
+			i->issueUndoExpired(log);
+		}
+	}
+	this->_unlock();
+}
+
 bool
 CompositeUndoStackObserver::_remove_one(UndoObserverRecordList& list, UndoStackObserver& o)
 {
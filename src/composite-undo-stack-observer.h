@@ -103,6 +103,16 @@ public:
 			this->_observer.notifyClearRedoEvent();
 		}
 
+		/**
+		 * Issue an undo expired event to the UndoStackObserver
+		 * that is associated with this
+		 * UndoStackObserverRecord.
+		 */
+		void issueUndoExpired(Event* log)
+		{
+			this->_observer.notifyUndoExpiredEvent(log);
+		}
+
 	private:
 		UndoStackObserver& _observer;
 	};
@@ -155,6 +165,13 @@ public:
 	void notifyClearUndoEvent() override;
 	void notifyClearRedoEvent() override;
 
+	/**
+	 * Notify all registered UndoStackObservers of the oldest event log being dropped.
+	 *
+	 * \param log The event log about to be deleted.
+	 */
+	void notifyUndoExpiredEvent(Event* log) override;
+
 private:
 	// Remove an observer from a given list
 	bool _remove_one(UndoObserverRecordList& list, UndoStackObserver& rec);
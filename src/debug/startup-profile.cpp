@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Inkscape::Debug::StartupStage - time taken by the stages of startup
+ *
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "debug/startup-profile.h"
+
+namespace Inkscape {
+
+namespace Debug {
+
+namespace {
+
+struct Stage {
+    char const *name;
+    int depth;
+    double milliseconds;
+};
+
+// Taken during static initialization, as close as we get to the start of the process.
+std::chrono::steady_clock::time_point const process_start = std::chrono::steady_clock::now();
+
+bool profile_enabled = false;
+int current_depth = 0;
+std::vector<Stage> stages;
+
+}
+
+StartupStage::StartupStage(char const *name)
+    : _index(-1)
+{
+    if (profile_enabled) {
+        _index = stages.size();
+        stages.push_back({name, current_depth++, 0.0});
+        _start = std::chrono::steady_clock::now();
+    }
+}
+
+StartupStage::~StartupStage()
+{
+    if (_index >= 0) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - _start;
+        stages[_index].milliseconds = elapsed.count();
+        --current_depth;
+    }
+}
+
+void StartupStage::enable()
+{
+    profile_enabled = true;
+}
+
+bool StartupStage::enabled()
+{
+    return profile_enabled;
+}
+
+void StartupStage::report()
+{
+    if (!profile_enabled) {
+        return;
+    }
+
+    std::chrono::duration<double, std::milli> total = std::chrono::steady_clock::now() - process_start;
+    std::cerr << "Startup profile (ms):" << std::endl;
+    for (auto const &stage : stages) {
+        std::cerr << std::fixed << std::setprecision(1) << std::setw(10) << stage.milliseconds << "  "
+                  << std::string(2 * stage.depth, ' ') << stage.name << std::endl;
+    }
+    std::cerr << std::fixed << std::setprecision(1) << std::setw(10) << total.count() << "  total" << std::endl;
+}
+
+}
+
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
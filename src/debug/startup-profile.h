@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Inkscape::Debug::StartupStage - time taken by the stages of startup
+ *
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_DEBUG_STARTUP_PROFILE_H
+#define SEEN_INKSCAPE_DEBUG_STARTUP_PROFILE_H
+
+#include <chrono>
+
+namespace Inkscape {
+
+namespace Debug {
+
+/**
+ * Measures a stage of startup while it is in scope, when enabled with
+ * --startup-profile. Stages may be nested.
+ */
+class StartupStage {
+public:
+    StartupStage(char const *name);
+    ~StartupStage();
+
+    StartupStage(StartupStage const &) = delete;
+    StartupStage &operator=(StartupStage const &) = delete;
+
+    static void enable();
+    static bool enabled();
+
+    /// Prints the stages measured so far to stderr.
+    static void report();
+
+private:
+    int _index;
+    std::chrono::steady_clock::time_point _start;
+};
+
+}
+
+}
+
+#endif
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -11,8 +11,14 @@
 
 #include "display/cairo-utils.h"
 
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <map>
 #include <stdexcept>
+#include <thread>
 
+#include <gio/gio.h>
 #include <glib/gstdio.h>
 #include <glibmm/fileutils.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
@@ -191,7 +197,16 @@ Pixbuf::Pixbuf(Inkscape::Pixbuf const &other)
     , _path(other._path)
     , _pixel_format(other._pixel_format)
     , _cairo_store(false)
-{}
+{
+    // keep the original compressed data, so that copies are still embedded without re-encoding
+    gsize len = 0;
+    std::string mimetype;
+    guchar const *data = other.getMimeData(len, mimetype);
+    if (data) {
+        guchar *copy = (guchar *) g_memdup(data, len);
+        cairo_surface_set_mime_data(_surface, mimetype.c_str(), copy, len, g_free, copy);
+    }
+}
 
 Pixbuf::~Pixbuf()
 {
@@ -389,6 +404,329 @@ Pixbuf *Pixbuf::create_from_buffer(std::string const &buffer, double svgdpi, std
     return Pixbuf::create_from_buffer(std::move(datacopy), buffer.size(), svgdpi, fn);
 }
 
+namespace {
+
+/**
+ * Decoded images shared by all documents. The images in use are found through weak
+ * pointers; on top of that, the most recently used images are kept alive up to a memory
+ * budget, so that an image shown again shortly after, e.g. on undo, is not decoded again.
+ */
+class PixbufCache {
+public:
+    static PixbufCache &get()
+    {
+        static PixbufCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<Pixbuf> lookup(std::string const &key)
+    {
+        auto found = _images.find(key);
+        if (found == _images.end()) {
+            return nullptr;
+        }
+        std::shared_ptr<Pixbuf> pb = found->second.lock();
+        if (!pb) {
+            _images.erase(found);
+            return nullptr;
+        }
+        _keep(key, pb);
+        return pb;
+    }
+
+    void insert(std::string const &key, std::shared_ptr<Pixbuf> const &pb)
+    {
+        if (_images.size() >= _sweep_size) {
+            for (auto it = _images.begin(); it != _images.end();) {
+                it = it->second.expired() ? _images.erase(it) : std::next(it);
+            }
+            _sweep_size = 2 * _images.size() + 64;
+        }
+        _images[key] = pb;
+        _keep(key, pb);
+    }
+
+    /// Images being decoded on worker threads
+    std::map<std::string, std::weak_ptr<PendingPixbuf> > pending;
+
+private:
+    void _keep(std::string const &key, std::shared_ptr<Pixbuf> const &pb)
+    {
+        for (auto it = _recent.begin(); it != _recent.end(); ++it) {
+            if (it->first == key) {
+                _recent.splice(_recent.begin(), _recent, it);
+                return;
+            }
+        }
+        _recent.emplace_front(key, pb);
+        _recent_size += _size(*pb);
+
+        Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+        std::size_t const budget = (std::size_t) prefs->getIntLimited("/options/imagecache/size", 64, 0, 4096) << 20;
+        while (_recent_size > budget && !_recent.empty()) {
+            _recent_size -= _size(*_recent.back().second);
+            _recent.pop_back();
+        }
+    }
+
+    static std::size_t _size(Pixbuf const &pb)
+    {
+        return (std::size_t) pb.rowstride() * pb.height();
+    }
+
+    std::map<std::string, std::weak_ptr<Pixbuf> > _images;
+    std::size_t _sweep_size = 64;
+    /// Most recently used first
+    std::list<std::pair<std::string, std::shared_ptr<Pixbuf> > > _recent;
+    std::size_t _recent_size = 0;
+};
+
+}
+
+std::shared_ptr<Pixbuf> Pixbuf::get_from_data_uri(gchar const *uri_data, double svgdpi)
+{
+    gchar *checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, uri_data, -1);
+    std::string const key = std::string("data:") + checksum + ":" + std::to_string(svgdpi);
+    g_free(checksum);
+
+    PixbufCache &cache = PixbufCache::get();
+    std::shared_ptr<Pixbuf> pb = cache.lookup(key);
+    if (!pb) {
+        pb.reset(create_from_data_uri(uri_data, svgdpi));
+        if (pb) {
+            cache.insert(key, pb);
+        }
+    }
+    return pb;
+}
+
+/**
+ * Cache key of a file, or an empty string if there is no such file.
+ * Times in seconds would miss a file rewritten at the same size within a second, so the key
+ * has the modification and status change times in microseconds, and the inode where there is
+ * one, which changes when a file is replaced by another.
+ */
+static std::string file_cache_key(std::string const &fn, double svgdpi)
+{
+    GFile *file = g_file_new_for_path(fn.c_str());
+    GFileInfo *info = g_file_query_info(file,
+                                        G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                        G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC ","
+                                        G_FILE_ATTRIBUTE_TIME_CHANGED "," G_FILE_ATTRIBUTE_TIME_CHANGED_USEC ","
+                                        G_FILE_ATTRIBUTE_UNIX_INODE,
+                                        G_FILE_QUERY_INFO_NONE, nullptr, nullptr);
+    g_object_unref(file);
+    if (!info) {
+        return std::string();
+    }
+
+    // Attributes the platform does not have read as 0
+    std::string key = "file:" + fn + ":" +
+        std::to_string(g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED)) + "." +
+        std::to_string(g_file_info_get_attribute_uint32(info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC)) + ":" +
+        std::to_string(g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_CHANGED)) + "." +
+        std::to_string(g_file_info_get_attribute_uint32(info, G_FILE_ATTRIBUTE_TIME_CHANGED_USEC)) + ":" +
+        std::to_string((gint64) g_file_info_get_size(info)) + ":" +
+        std::to_string(g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_UNIX_INODE)) + ":" +
+        std::to_string(svgdpi);
+    g_object_unref(info);
+    return key;
+}
+
+std::shared_ptr<Pixbuf> Pixbuf::get_from_file(std::string const &fn, double svgdpi)
+{
+    std::string const key = file_cache_key(fn, svgdpi);
+    if (key.empty()) {
+        return nullptr;
+    }
+
+    PixbufCache &cache = PixbufCache::get();
+    std::shared_ptr<Pixbuf> pb = cache.lookup(key);
+    if (!pb) {
+        auto found = cache.pending.find(key);
+        if (found != cache.pending.end()) {
+            if (auto pending = found->second.lock()) {
+                return pending->wait();
+            }
+        }
+        pb.reset(create_from_file(fn, svgdpi));
+        if (pb) {
+            cache.insert(key, pb);
+        }
+    }
+    return pb;
+}
+
+/**
+ * Worker threads decoding images, for as long as the program runs.
+ */
+class PendingPixbuf::Decoder {
+public:
+    static void push(std::shared_ptr<PendingPixbuf> const &pending)
+    {
+        // never destroyed, the detached threads wait on it until the program exits
+        static Decoder *decoder = new Decoder();
+        {
+            std::lock_guard<std::mutex> lock(decoder->_mutex);
+            decoder->_queue.push_back(pending);
+        }
+        decoder->_queued.notify_one();
+    }
+
+private:
+    Decoder()
+    {
+        unsigned const threads = std::max(1u, std::min(std::thread::hardware_concurrency(), 4u));
+        for (unsigned i = 0; i < threads; ++i) {
+            std::thread(&Decoder::_run, this).detach();
+        }
+    }
+
+    void _run()
+    {
+        for (;;) {
+            std::shared_ptr<PendingPixbuf> pending;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _queued.wait(lock, [this] { return !_queue.empty(); });
+                pending = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            pending->_decode();
+            // the main thread may have decoded it in the meantime, it is done either way
+            g_idle_add(&PendingPixbuf::_emitDone, new std::shared_ptr<PendingPixbuf>(std::move(pending)));
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _queued;
+    std::deque<std::shared_ptr<PendingPixbuf> > _queue;
+};
+
+std::shared_ptr<PendingPixbuf> Pixbuf::get_from_file_async(std::string const &fn, double svgdpi)
+{
+    // SVG images are rendered from a document, which only works on the main thread
+    std::string::size_type const idx = fn.rfind('.');
+    if (idx != std::string::npos && boost::iequals(fn.substr(idx + 1), "svg")) {
+        return nullptr;
+    }
+    int width = 0;
+    int height = 0;
+    if (!gdk_pixbuf_get_file_info(fn.c_str(), &width, &height)) {
+        return nullptr;
+    }
+    std::string const key = file_cache_key(fn, svgdpi);
+    if (key.empty()) {
+        return nullptr;
+    }
+
+    PixbufCache &cache = PixbufCache::get();
+    std::shared_ptr<PendingPixbuf> pending;
+    auto found = cache.pending.find(key);
+    if (found != cache.pending.end()) {
+        pending = found->second.lock();
+        if (pending) {
+            return pending;
+        }
+    }
+
+    pending = std::make_shared<PendingPixbuf>(key, fn, svgdpi, width, height);
+    if (std::shared_ptr<Pixbuf> pb = cache.lookup(key)) {
+        pending->_state = PendingPixbuf::DECODED;
+        pending->_finished = true;
+        pending->_result = pb;
+        return pending;
+    }
+    cache.pending[key] = pending;
+    PendingPixbuf::Decoder::push(pending);
+    return pending;
+}
+
+PendingPixbuf::PendingPixbuf(std::string key, std::string fn, double svgdpi, int width, int height)
+    : _key(std::move(key))
+    , _fn(std::move(fn))
+    , _svgdpi(svgdpi)
+    , _width(width)
+    , _height(height)
+    , _state(QUEUED)
+    , _decoded(nullptr)
+    , _finished(false)
+{}
+
+PendingPixbuf::~PendingPixbuf()
+{
+    delete _decoded;
+}
+
+bool PendingPixbuf::done()
+{
+    if (_finished) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _state == DECODED;
+}
+
+std::shared_ptr<Pixbuf> PendingPixbuf::wait()
+{
+    if (!_finished) {
+        if (!_decode()) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _decoded_cond.wait(lock, [this] { return _state == DECODED; });
+        }
+        _finish();
+    }
+    return _result;
+}
+
+/// Decodes the image, unless someone else has started already. Runs on any thread.
+bool PendingPixbuf::_decode()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_state != QUEUED) {
+            return false;
+        }
+        _state = DECODING;
+    }
+
+    // raster images only: this does not touch documents nor preferences
+    Pixbuf *pb = Pixbuf::create_from_file(_fn, _svgdpi);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _decoded = pb;
+        _state = DECODED;
+    }
+    _decoded_cond.notify_all();
+    return true;
+}
+
+/// Hands the decoded image over to the main thread.
+void PendingPixbuf::_finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _result.reset(_decoded);
+        _decoded = nullptr;
+    }
+    _finished = true;
+
+    PixbufCache &cache = PixbufCache::get();
+    cache.pending.erase(_key);
+    if (_result) {
+        cache.insert(_key, _result);
+    }
+}
+
+int PendingPixbuf::_emitDone(void *data)
+{
+    std::unique_ptr<std::shared_ptr<PendingPixbuf> > pending(static_cast<std::shared_ptr<PendingPixbuf> *>(data));
+    (*pending)->wait();
+    (*pending)->signal_done.emit();
+    return FALSE;
+}
+
 Pixbuf *Pixbuf::create_from_buffer(gchar *&&data, gsize len, double svgdpi, std::string const &fn)
 {
     Pixbuf *pb = nullptr;
@@ -1532,9 +1870,12 @@ guint32 pixbuf_from_argb32(guint32 c)
     guint32 b = (c & 0x000000ff);
     // unpremultiply; adding a/2 gives correct rounding
     // (taken from Cairo sources)
-    r = (r * 255 + a/2) / a;
-    b = (b * 255 + a/2) / a;
-    g = (g * 255 + a/2) / a;
+    // (opaque pixels, the bulk of most images, come out unchanged)
+    if (a != 255) {
+        r = (r * 255 + a/2) / a;
+        b = (b * 255 + a/2) / a;
+        g = (g * 255 + a/2) / a;
+    }
     // combine into output
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
     guint32 o = (r) | (g << 8) | (b << 16) | (a << 24);
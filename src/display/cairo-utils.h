@@ -13,8 +13,12 @@
 #ifndef SEEN_INKSCAPE_DISPLAY_CAIRO_UTILS_H
 #define SEEN_INKSCAPE_DISPLAY_CAIRO_UTILS_H
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <2geom/forward.h>
 #include <cairomm/cairomm.h>
+#include <sigc++/signal.h>
 #include "style.h"
 
 struct SPColor;
@@ -25,6 +29,57 @@ void convert_pixbuf_argb32_to_normal(GdkPixbuf *pb);
 
 namespace Inkscape {
 
+class Pixbuf;
+
+/**
+ * A raster image file being decoded on a worker thread, see Pixbuf::get_from_file_async().
+ * Only used from the main thread.
+ */
+class PendingPixbuf {
+public:
+    PendingPixbuf(std::string key, std::string fn, double svgdpi, int width, int height);
+    ~PendingPixbuf();
+
+    /// Size of the image, as given by the header of the file
+    int width() const { return _width; }
+    int height() const { return _height; }
+
+    /// Whether the image is decoded, so that wait() returns at once.
+    bool done();
+    /**
+     * Returns the image, or null if it could not be decoded. Decodes it right away if no
+     * worker has started on it yet, else waits for the worker to finish it.
+     */
+    std::shared_ptr<Pixbuf> wait();
+
+    /// Emitted once the image is decoded, from the main loop
+    sigc::signal<void> signal_done;
+
+private:
+    friend class Pixbuf;
+    class Decoder;
+
+    bool _decode();
+    void _finish();
+    static int _emitDone(void *data);
+
+    enum State { QUEUED, DECODING, DECODED };
+
+    std::string const _key;
+    std::string const _fn;
+    double const _svgdpi;
+    int const _width;
+    int const _height;
+
+    std::mutex _mutex;
+    std::condition_variable _decoded_cond;
+    State _state;
+    Pixbuf *_decoded;
+
+    bool _finished;
+    std::shared_ptr<Pixbuf> _result;
+};
+
 /**
  * RAII idiom for Cairo groups.
  * Groups are temporary surfaces used when rendering e.g. masks and opacity.
@@ -122,6 +177,20 @@ public:
     static Pixbuf *create_from_file(std::string const &fn, double svgddpi = 0);
     static Pixbuf *create_from_buffer(std::string const &, double svgddpi = 0, std::string const &fn = "");
 
+    /**
+     * Like create_from_data_uri() and create_from_file(), but shares the decoded image with
+     * everyone else who loads the same data URI, or the same unchanged file, at the same
+     * resolution. Shared pixbufs must not be modified: copy them first.
+     */
+    static std::shared_ptr<Pixbuf> get_from_data_uri(gchar const *uri, double svgdpi = 0);
+    static std::shared_ptr<Pixbuf> get_from_file(std::string const &fn, double svgdpi = 0);
+
+    /**
+     * Like get_from_file(), but decodes the image on a worker thread. Returns null for
+     * files that are not raster images, which must be loaded with get_from_file().
+     */
+    static std::shared_ptr<PendingPixbuf> get_from_file_async(std::string const &fn, double svgdpi = 0);
+
   private:
     static Pixbuf *create_from_buffer(gchar *&&, gsize, double svgddpi = 0, std::string const &fn = "");
 
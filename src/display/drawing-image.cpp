@@ -39,6 +39,14 @@ DrawingImage::setPixbuf(Inkscape::Pixbuf *pb)
     _markForUpdate(STATE_ALL, false);
 }
 
+void
+DrawingImage::setPending(std::shared_ptr<Inkscape::PendingPixbuf> pending)
+{
+    _pending = std::move(pending);
+
+    _markForUpdate(STATE_ALL, false);
+}
+
 void
 DrawingImage::setScale(double sx, double sy)
 {
@@ -63,10 +71,17 @@ DrawingImage::setClipbox(Geom::Rect const &box)
 Geom::Rect
 DrawingImage::bounds() const
 {
-    if (!_pixbuf) return _clipbox;
+    double pw, ph;
+    if (_pixbuf) {
+        pw = _pixbuf->width();
+        ph = _pixbuf->height();
+    } else if (_pending) {
+        pw = _pending->width();
+        ph = _pending->height();
+    } else {
+        return _clipbox;
+    }
 
-    double pw = _pixbuf->width();
-    double ph = _pixbuf->height();
     double vw = pw * _scale[Geom::X];
     double vh = ph * _scale[Geom::Y];
     Geom::Point wh(vw, vh);
@@ -83,7 +98,7 @@ DrawingImage::_updateItem(Geom::IntRect const &, UpdateContext const &, unsigned
     _markForRendering();
 
     // Calculate bbox
-    if (_pixbuf) {
+    if (_pixbuf || _pending) {
         Geom::Rect r = bounds() * _ctm;
         _bbox = r.roundOutwards();
     } else {
@@ -101,7 +116,16 @@ unsigned DrawingImage::_renderItem(DrawingContext &dc, Geom::IntRect const &/*ar
     bool imgoutline = prefs->getBool("/options/rendering/imageinoutlinemode", false);
 
     if (!outline || imgoutline) {
-        if (!_pixbuf) return RENDER_OK;
+        Inkscape::Pixbuf *pixbuf = _pixbuf;
+        if (!pixbuf && _pending) {
+            // on screen, do not hold up drawing for the image; anywhere else, wait for it
+            if (_drawing.arena() && !_pending->done()) {
+                _renderPlaceholder(dc);
+                return RENDER_OK;
+            }
+            pixbuf = _pending->wait().get();
+        }
+        if (!pixbuf) return RENDER_OK;
 
         Inkscape::DrawingContext::Save save(dc);
         dc.transform(_ctm);
@@ -111,7 +135,7 @@ unsigned DrawingImage::_renderItem(DrawingContext &dc, Geom::IntRect const &/*ar
 
         dc.translate(_origin);
         dc.scale(_scale);
-        dc.setSource(_pixbuf->getSurfaceRaw(), 0, 0);
+        dc.setSource(pixbuf->getSurfaceRaw(), 0, 0);
         dc.patternSetExtend(CAIRO_EXTEND_PAD);
 
         if (_style) {
@@ -173,6 +197,27 @@ unsigned DrawingImage::_renderItem(DrawingContext &dc, Geom::IntRect const &/*ar
     return RENDER_OK;
 }
 
+/** The image if it is decoded, else null. */
+Inkscape::Pixbuf *
+DrawingImage::_decodedPixbuf() const
+{
+    if (!_pixbuf && _pending && _pending->done()) {
+        return _pending->wait().get();
+    }
+    return _pixbuf;
+}
+
+void
+DrawingImage::_renderPlaceholder(DrawingContext &dc)
+{
+    Inkscape::DrawingContext::Save save(dc);
+    dc.transform(_ctm);
+    dc.newPath();
+    dc.rectangle(bounds());
+    dc.setSource(0x80808040);
+    dc.fill();
+}
+
 /** Calculates the closest distance from p to the segment a1-a2*/
 static double
 distance_to_segment (Geom::Point const &p, Geom::Point const &a1, Geom::Point const &a2)
@@ -185,7 +230,7 @@ distance_to_segment (Geom::Point const &p, Geom::Point const &a1, Geom::Point co
 DrawingItem *
 DrawingImage::_pickItem(Geom::Point const &p, double delta, unsigned /*sticky*/)
 {
-    if (!_pixbuf) return nullptr;
+    if (!_pixbuf && !_pending) return nullptr;
 
     bool outline = _drawing.outline() || _drawing.getOutlineSensitive();
 
@@ -205,17 +250,22 @@ DrawingImage::_pickItem(Geom::Point const &p, double delta, unsigned /*sticky*/)
         return nullptr;
 
     } else {
-        unsigned char *const pixels = _pixbuf->pixels();
-        int width = _pixbuf->width();
-        int height = _pixbuf->height();
-        size_t rowstride = _pixbuf->rowstride();
-
         Geom::Point tp = p * _ctm.inverse();
         Geom::Rect r = bounds();
 
         if (!r.contains(tp))
             return nullptr;
 
+        // until the image is decoded, all of it can be picked
+        Inkscape::Pixbuf *pixbuf = _decodedPixbuf();
+        if (!pixbuf)
+            return this;
+
+        unsigned char *const pixels = pixbuf->pixels();
+        int width = pixbuf->width();
+        int height = pixbuf->height();
+        size_t rowstride = pixbuf->rowstride();
+
         double vw = width * _scale[Geom::X];
         double vh = height * _scale[Geom::Y];
         int ix = floor((tp[Geom::X] - _origin[Geom::X]) / vw * width);
@@ -227,10 +277,10 @@ DrawingImage::_pickItem(Geom::Point const &p, double delta, unsigned /*sticky*/)
         unsigned char *pix_ptr = pixels + iy * rowstride + ix * 4;
         // pick if the image is less than 99% transparent
         guint32 alpha = 0;
-        if (_pixbuf->pixelFormat() == Inkscape::Pixbuf::PF_CAIRO) {
+        if (pixbuf->pixelFormat() == Inkscape::Pixbuf::PF_CAIRO) {
             guint32 px = *reinterpret_cast<guint32 const *>(pix_ptr);
             alpha = (px & 0xff000000) >> 24;
-        } else if (_pixbuf->pixelFormat() == Inkscape::Pixbuf::PF_GDK) {
+        } else if (pixbuf->pixelFormat() == Inkscape::Pixbuf::PF_GDK) {
             alpha = pix_ptr[3];
         } else {
             throw std::runtime_error("Unrecognized pixel format");
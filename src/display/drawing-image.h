@@ -13,6 +13,7 @@
 #ifndef SEEN_INKSCAPE_DISPLAY_DRAWING_IMAGE_H
 #define SEEN_INKSCAPE_DISPLAY_DRAWING_IMAGE_H
 
+#include <memory>
 #include <cairo.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <2geom/transforms.h>
@@ -21,6 +22,7 @@
 
 namespace Inkscape {
 class Pixbuf;
+class PendingPixbuf;
 
 class DrawingImage
     : public DrawingItem
@@ -30,6 +32,8 @@ public:
     ~DrawingImage() override;
 
     void setPixbuf(Inkscape::Pixbuf *pb);
+    /// The image while it is decoded, shown as a placeholder on screen until it is done
+    void setPending(std::shared_ptr<Inkscape::PendingPixbuf> pending);
     void setScale(double sx, double sy);
     void setOrigin(Geom::Point const &o);
     void setClipbox(Geom::Rect const &box);
@@ -42,7 +46,11 @@ protected:
                                  DrawingItem *stop_at) override;
     DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) override;
 
+    Inkscape::Pixbuf *_decodedPixbuf() const;
+    void _renderPlaceholder(DrawingContext &dc);
+
     Inkscape::Pixbuf *_pixbuf;
+    std::shared_ptr<Inkscape::PendingPixbuf> _pending;
 
     // TODO: the following three should probably be merged into a new Geom::Viewbox object
     Geom::Rect _clipbox; ///< for preserveAspectRatio
@@ -32,6 +32,9 @@
 
 namespace Inkscape {
 
+/// Paths with fewer curves are picked by looking at all of them
+static unsigned const PICK_INDEX_MIN_CURVES = 64;
+
 DrawingShape::DrawingShape(Drawing &drawing)
     : DrawingItem(drawing)
     , _curve(nullptr)
@@ -58,6 +61,7 @@ DrawingShape::setPath(SPCurve *curve)
         _curve = curve;
         curve->ref();
     }
+    _pick_index.reset();
 
     _markForUpdate(STATE_ALL, false);
 }
@@ -369,7 +373,15 @@ DrawingShape::_pickItem(Geom::Point const &p, double delta, unsigned flags)
         (_style->fill_rule.computed == SP_WIND_RULE_EVENODD);
 
     // actual shape picking
-    if (_drawing.arena()) {
+    Geom::PathVector const &pathv = _curve->get_pathvector();
+    if (pathv.curveCount() >= PICK_INDEX_MIN_CURVES) {
+        // only the curves near the point or left of it on its line are looked at
+        if (!_pick_index || _pick_index->transform() != _ctm) {
+            _pick_index.reset(new PathvPickIndex(pathv, _ctm));
+        }
+        dist = width + delta;
+        _pick_index->windDistance(p, needfill ? &wind : nullptr, &dist, 0.5);
+    } else if (_drawing.arena()) {
         Geom::Rect viewbox = _drawing.arena()->item.canvas->getViewbox();
         viewbox.expandBy (width);
         pathv_matrix_point_bbox_wind_distance(_curve->get_pathvector(), _ctm, p, nullptr, needfill? &wind : nullptr, &dist, 0.5, &viewbox);
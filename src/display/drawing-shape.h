@@ -13,11 +13,14 @@
 #ifndef SEEN_INKSCAPE_DISPLAY_DRAWING_SHAPE_H
 #define SEEN_INKSCAPE_DISPLAY_DRAWING_SHAPE_H
 
+#include <memory>
+
 #include "display/drawing-item.h"
 #include "display/nr-style.h"
 
 class SPStyle;
 class SPCurve;
+class PathvPickIndex;
 
 namespace Inkscape {
 
@@ -51,6 +54,8 @@ protected:
 
     DrawingItem *_last_pick;
     unsigned _repick_after;
+    /// Curves of complex paths in screen coordinates for picking, built on first use at each zoom
+    std::unique_ptr<PathvPickIndex> _pick_index;
 };
 
 } // end namespace Inkscape
@@ -31,7 +31,6 @@ FilterImage::FilterImage()
     : SVGElem(nullptr)
     , document(nullptr)
     , feImageHref(nullptr)
-    , image(nullptr)
     , broken_ref(false)
 { }
 
@@ -43,7 +42,6 @@ FilterImage::~FilterImage()
 {
     if (feImageHref)
         g_free(feImageHref);
-    delete image;
 }
 
 void FilterImage::render_cairo(FilterSlot &slot)
@@ -166,7 +164,7 @@ void FilterImage::render_cairo(FilterSlot &slot)
             g_warning("FilterImage::render: Can not find: %s", feImageHref  );
             return;
         }
-        image = Inkscape::Pixbuf::create_from_file(fullname);
+        image = Inkscape::Pixbuf::get_from_file(fullname);
         if( fullname != feImageHref ) g_free( fullname );
 
         if ( !image ) {
@@ -312,8 +310,7 @@ void FilterImage::set_href(const gchar *href){
     if (feImageHref) g_free (feImageHref);
     feImageHref = (href) ? g_strdup (href) : nullptr;
 
-    delete image;
-    image = nullptr;
+    image.reset();
     broken_ref = false;
 }
 
@@ -13,6 +13,7 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <memory>
 #include "display/nr-filter-primitive.h"
 
 class SPDocument;
@@ -46,7 +47,7 @@ public:
 private:
     SPDocument *document;
     char *feImageHref;
-    Inkscape::Pixbuf *image;
+    std::shared_ptr<Inkscape::Pixbuf> image;
     float feImageX, feImageY, feImageWidth, feImageHeight;
     unsigned int aspect_align, aspect_clip;
     bool broken_ref;
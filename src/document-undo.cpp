@@ -45,15 +45,46 @@
  * (Lauris Kaplinski)
  */
 
+#include <algorithm>
 #include <string>
 #include "xml/repr.h"
 #include "inkscape.h"
 #include "document-undo.h"
+#include "preferences.h"
 #include "debug/event-tracker.h"
 #include "debug/simple-event.h"
 #include "debug/timestamp.h"
 #include "event.h"
 
+namespace {
+
+/// The undo history budget from /options/undo/memory in bytes, 0 for no limit
+class UndoMemoryBudget : public Inkscape::Preferences::Observer {
+public:
+    UndoMemoryBudget()
+        : Inkscape::Preferences::Observer("/options/undo/memory")
+    {
+        Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+        notify(prefs->getEntry(observed_path));
+        prefs->addObserver(*this);
+    }
+
+    void notify(Inkscape::Preferences::Entry const &entry) override
+    {
+        bytes = static_cast<std::size_t>(std::max(entry.getInt(256), 0)) << 20;
+    }
+
+    std::size_t bytes = 0;
+};
+
+std::size_t undo_memory_budget()
+{
+    // Never deleted: the observer would outlive the preferences at exit
+    static UndoMemoryBudget *budget = new UndoMemoryBudget();
+    return budget->bytes;
+}
+
+}
 
 /*
  * Undo & redo
@@ -149,15 +180,22 @@ void Inkscape::DocumentUndo::maybeDone(SPDocument *doc, const gchar *key, const
 	}
 
 	if (key && !doc->actionkey.empty() && (doc->actionkey == key) && !doc->undo.empty()) {
-                (doc->undo.back())->event =
-                    sp_repr_coalesce_log ((doc->undo.back())->event, log);
+                Inkscape::Event *event = doc->undo.back();
+                event->event = sp_repr_compact_log(sp_repr_coalesce_log(event->event, log));
+                doc->history_memory -= event->memory;
+                event->memory = sp_repr_log_memory(event->event);
+                doc->history_memory += event->memory;
 	} else {
-                Inkscape::Event *event = new Inkscape::Event(log, event_type, event_description);
+                Inkscape::Event *event = new Inkscape::Event(sp_repr_compact_log(log), event_type, event_description);
+                event->memory = sp_repr_log_memory(event->event);
+                doc->history_memory += event->memory;
                 doc->undo.push_back(event);
 		doc->history_size++;
 		doc->undoStackObservers.notifyUndoCommitEvent(event);
 	}
 
+        expire_undo(*doc);
+
         if ( key ) {
             doc->actionkey = key;
         } else {
@@ -197,6 +235,8 @@ void Inkscape::DocumentUndo::finish_incomplete_transaction(SPDocument &doc) {
 		doc.partial = sp_repr_coalesce_log(doc.partial, log);
 		sp_repr_debug_print_log(doc.partial);
                 Inkscape::Event *event = new Inkscape::Event(doc.partial);
+                event->memory = sp_repr_log_memory(event->event);
+                doc.history_memory += event->memory;
 		doc.undo.push_back(event);
                 doc.undoStackObservers.notifyUndoCommitEvent(event);
 		doc.partial = nullptr;
@@ -218,13 +258,34 @@ void Inkscape::DocumentUndo::perform_document_update(SPDocument &doc) {
         //Coalesce the update changes with the last action performed by user
         if (!doc.undo.empty()) {
             Inkscape::Event* undo_stack_top = doc.undo.back();
-            undo_stack_top->event = sp_repr_coalesce_log(undo_stack_top->event, update_log);
+            undo_stack_top->event = sp_repr_compact_log(sp_repr_coalesce_log(undo_stack_top->event, update_log));
+            doc.history_memory -= undo_stack_top->memory;
+            undo_stack_top->memory = sp_repr_log_memory(undo_stack_top->event);
+            doc.history_memory += undo_stack_top->memory;
         } else {
             sp_repr_free_log(update_log);
         }
     }
 }
 
+// Member function for friend access to SPDocument privates.
+void Inkscape::DocumentUndo::expire_undo(SPDocument &doc) {
+    std::size_t const budget = undo_memory_budget();
+    if (budget == 0 || doc.history_memory <= budget) {
+        return;
+    }
+
+    // Drop the oldest history, but always keep the latest step undoable
+    while (doc.history_memory > budget && doc.undo.size() > 1) {
+        Inkscape::Event *event = doc.undo.front();
+        doc.undo.erase(doc.undo.begin());
+        doc.history_memory -= event->memory;
+        doc.undoStackObservers.notifyUndoExpiredEvent(event);
+        delete event;
+        doc.history_size--;
+    }
+}
+
 gboolean Inkscape::DocumentUndo::undo(SPDocument *doc)
 {
     using Inkscape::Debug::EventTracker;
@@ -323,6 +384,7 @@ void Inkscape::DocumentUndo::clearUndo(SPDocument *doc)
     while (! doc->undo.empty()) {
         Inkscape::Event *e = doc->undo.back();
         doc->undo.pop_back();
+        doc->history_memory -= e->memory;
         delete e;
         doc->history_size--;
     }
@@ -336,6 +398,7 @@ void Inkscape::DocumentUndo::clearRedo(SPDocument *doc)
     while (! doc->redo.empty()) {
         Inkscape::Event *e = doc->redo.back();
         doc->redo.pop_back();
+        doc->history_memory -= e->memory;
         delete e;
         doc->history_size--;
     }
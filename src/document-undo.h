@@ -46,6 +46,8 @@ private:
 
     static void perform_document_update(SPDocument &document);
 
+    static void expire_undo(SPDocument &document);
+
 public:
     static void resetKey(SPDocument *document);
 
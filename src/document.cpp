@@ -37,8 +37,12 @@
 #define noSP_DOCUMENT_DEBUG_IDLE
 #define noSP_DOCUMENT_DEBUG_UNDO
 
-#include <string>
+#include <algorithm>
 #include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <2geom/transforms.h>
 
@@ -53,7 +57,12 @@
 #include "profile-manager.h"
 #include "rdf.h"
 
+#include "debug/event-tracker.h"
+#include "debug/logger.h"
+#include "debug/simple-event.h"
+
 #include "display/drawing.h"
+#include "display/drawing-item.h"
 
 #include "3rdparty/adaptagrams/libavoid/router.h"
 
@@ -71,6 +80,8 @@
 
 #include "widgets/desktop-widget.h"
 
+#include "util/rtree.h"
+
 #include "xml/croco-node-iface.h"
 #include "xml/rebase-hrefs.h"
 
@@ -93,6 +104,25 @@ static gint doc_mem_count = 0;
 
 static unsigned long next_serial = 0;
 
+extern guint update_object_count;
+extern guint modified_object_count;
+
+namespace {
+
+typedef Inkscape::Debug::SimpleEvent<Inkscape::Debug::Event::DOCUMENT> DebugDocument;
+
+class DebugDocumentUpdatePass : public DebugDocument {
+public:
+    DebugDocumentUpdatePass(guint updated, guint modified)
+        : DebugDocument("update-pass")
+    {
+        _addProperty("updated", static_cast<long>(updated));
+        _addProperty("modified", static_cast<long>(modified));
+    }
+};
+
+}
+
 SPDocument::SPDocument() :
     keepalive(false),
     virgin(true),
@@ -112,7 +142,6 @@ SPDocument::SPDocument() :
     current_persp3d(nullptr),
     current_persp3d_impl(nullptr),
     _parent_document(nullptr),
-    _node_cache_valid(false),
     _activexmltree(nullptr)
 {
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
@@ -137,7 +166,6 @@ SPDocument::SPDocument() :
 
     // XXX only for testing!
     undoStackObservers.add(console_output_undo_observer);
-    _node_cache = std::deque<SPItem*>();
 }
 
 SPDocument::~SPDocument() {
@@ -1077,6 +1105,22 @@ void _getObjectsBySelectorRecursive(SPObject *parent,
     }
 }
 
+/**
+ * Returns the id required by the rightmost compound selector of a selector chain, if any.
+ */
+static gchar const *_getSelectorSubjectId(CRSimpleSel const *simple_sel)
+{
+    while (simple_sel->next) {
+        simple_sel = simple_sel->next;
+    }
+    for (auto add_sel = simple_sel->add_sel; add_sel; add_sel = add_sel->next) {
+        if (add_sel->type == ID_ADD_SELECTOR && add_sel->content.id_name && add_sel->content.id_name->stryng) {
+            return add_sel->content.id_name->stryng->str;
+        }
+    }
+    return nullptr;
+}
+
 std::vector<SPObject *> SPDocument::getObjectsBySelector(Glib::ustring const &selector) const
 {
     // std::cout << "\nSPDocument::getObjectsBySelector: " << selector << std::endl;
@@ -1096,10 +1140,26 @@ std::vector<SPObject *> SPDocument::getObjectsBySelector(Glib::ustring const &se
     // std::cout << "  selector: |" << (cr_string?cr_string:"Empty") << "|" << std::endl;
     CRSelector const *cur = nullptr;
     for (cur = cr_selector; cur; cur = cur->next) {
-        if (cur->simple_sel ) {
+        if (!cur->simple_sel) {
+            continue;
+        }
+        if (gchar const *id = _getSelectorSubjectId(cur->simple_sel)) {
+            // Ids are unique, so only the object carrying it can match: no need to walk the tree.
+            SPObject *object = getObjectById(id);
+            gboolean result = false;
+            if (object) {
+                cr_sel_eng_matches_node(sel_eng, cur->simple_sel, object->getRepr(), &result);
+            }
+            if (result) {
+                objects.push_back(object);
+            }
+        } else {
             _getObjectsBySelectorRecursive(root, sel_eng, cur->simple_sel, objects);
         }
     }
+    if (cr_selector) {
+        cr_selector_unref(cr_selector);
+    }
     return objects;
 }
 
@@ -1197,6 +1257,10 @@ SPDocument::_updateDocument(int update_flags)
 {
     /* Process updates */
     if (this->root->uflags || this->root->mflags) {
+        Inkscape::Debug::EventTracker<DebugDocument> tracker("update-document");
+        update_object_count = 0;
+        modified_object_count = 0;
+
         if (this->root->uflags) {
             SPItemCtx ctx;
             setupViewport(&ctx);
@@ -1206,6 +1270,9 @@ SPDocument::_updateDocument(int update_flags)
             this->root->updateDisplay((SPCtx *)&ctx, update_flags);
         }
         this->_emitModified();
+
+        // Only the dirty subtrees are visited, so these count the objects that changed
+        Inkscape::Debug::Logger::write<DebugDocumentUpdatePass>(update_object_count, modified_object_count);
     }
 
     return !(this->root->uflags || this->root->mflags);
@@ -1296,38 +1363,281 @@ static bool overlaps(Geom::Rect const &area, Geom::Rect const &box)
 }
 
 /**
- * @param area Area in document coordinates
+ * Whether the item is one the item index has, i.e. all its ancestors up to the root are
+ * groups. Items in clones and in defs are not.
  */
-static std::vector<SPItem*> &find_items_in_area(std::vector<SPItem*> &s,
-                                                SPGroup *group, unsigned int dkey,
-                                                Geom::Rect const &area,
-                                                bool (*test)(Geom::Rect const &, Geom::Rect const &),
-                                                bool take_hidden = false,
-                                                bool take_insensitive = false,
-                                                bool take_groups = true,
-                                                bool enter_groups = false)
+static bool is_indexed_item(SPObject const *object, SPObject const *root)
 {
-    g_return_val_if_fail(SP_IS_GROUP(group), s);
+    if (!SP_IS_ITEM(object)) {
+        return false;
+    }
+    for (SPObject const *o = object->parent; o; o = o->parent) {
+        if (o == root) {
+            return true;
+        }
+        if (!SP_IS_GROUP(o)) {
+            return false;
+        }
+    }
+    return false;
+}
 
-    for (auto& o: group->children) {
-        if (SPItem *item = dynamic_cast<SPItem *>(&o)) {
-            if (!take_insensitive && item->isLocked()) {
-                continue;
+/**
+ * The items of the document with spatial indices over their bounding boxes.
+ *
+ * Items are numbered in the order the tree walks of the queries used to report
+ * them: children before their group, siblings in z-order. The indices are built
+ * on first use. Adding, removing or reordering items only marks the numbering out
+ * of date; it is redone with one walk of the document before the next query. The
+ * trees themselves are never rebuilt for that. An item that was added, or whose
+ * bounds may have changed, is marked in the trees: queries test its current box
+ * instead of the one in the tree. The entries of removed items are ignored. Once
+ * enough entries are out of date to make building a tree again worthwhile, it is
+ * rebuilt.
+ */
+struct SPDocument::ItemIndex {
+    struct BoundsIndex {
+        bool built = false;
+        Inkscape::Util::RTree<SPItem *> tree;
+        std::unordered_set<SPItem const *> stale; ///< Items whose entry in the tree is out of date or gone
+        std::unordered_set<SPItem *> changed;     ///< Indexed items whose current box is tested instead
+    };
+
+    SPGroup *root;
+    std::vector<SPItem *> items;
+    std::unordered_map<SPObject const *, unsigned> order;
+    bool order_dirty = true;
+
+    BoundsIndex area_index;                     ///< Document visual bounds
+    std::map<unsigned, BoundsIndex> point_index; ///< Drawing bounds in document coordinates, by display key
+
+    explicit ItemIndex(SPGroup *root)
+        : root(root)
+    {}
+
+    /// Numbers the items again if items were added, removed or reordered since the last time.
+    void updateOrder()
+    {
+        if (order_dirty) {
+            items.clear();
+            order.clear();
+            add(root);
+            order_dirty = false;
+        }
+    }
+
+    void add(SPGroup *group)
+    {
+        for (auto& o: group->children) {
+            if (SPItem *item = dynamic_cast<SPItem *>(&o)) {
+                if (SPGroup *childgroup = dynamic_cast<SPGroup *>(item)) {
+                    add(childgroup);
+                }
+                order.emplace(item, items.size());
+                items.push_back(item);
             }
+        }
+    }
+
+    void itemAdded(SPItem *item)
+    {
+        order_dirty = true;
+        itemModified(item);
+    }
+
+    void itemModified(SPItem *item)
+    {
+        markChanged(area_index, item);
+        for (auto &index : point_index) {
+            markChanged(index.second, item);
+        }
+    }
+
+    /// Drops the item and its descendants from the trees. Called before they are released.
+    void itemRemoved(SPItem *item)
+    {
+        order_dirty = true;
+        markRemoved(area_index, item);
+        for (auto &index : point_index) {
+            markRemoved(index.second, item);
+        }
+    }
 
-            if (!take_hidden && item->isHidden()) {
-                continue;
+    static void markChanged(BoundsIndex &index, SPItem *item)
+    {
+        if (index.built) {
+            // The item may also be a new one at the address of a removed one
+            index.stale.insert(item);
+            index.changed.insert(item);
+        }
+    }
+
+    static void markRemoved(BoundsIndex &index, SPItem *item)
+    {
+        if (!index.built) {
+            return;
+        }
+        index.stale.insert(item);
+        index.changed.erase(item);
+        if (SPGroup *group = dynamic_cast<SPGroup *>(item)) {
+            for (auto &o : group->children) {
+                if (SPItem *child = dynamic_cast<SPItem *>(&o)) {
+                    markRemoved(index, child);
+                }
             }
+        }
+    }
 
-            if (SPGroup * childgroup = dynamic_cast<SPGroup *>(item)) {
-                bool is_layer = childgroup->effectiveLayerMode(dkey) == SPGroup::LAYER;
-                if (is_layer || (enter_groups)) {
-                    s = find_items_in_area(s, childgroup, dkey, area, test, take_hidden, take_insensitive, take_groups, enter_groups);
+    /**
+     * Calls @a f with the number of every item whose box, as given by @a box_of, intersects
+     * @a area, in no particular order. The numbering must be up to date.
+     */
+    template <typename Box, typename F>
+    void search(BoundsIndex &index, Geom::Rect const &area, Box const &box_of, F f)
+    {
+        if (!index.built || index.stale.size() > std::max<std::size_t>(64, items.size() / 16)) {
+            std::vector<Inkscape::Util::RTree<SPItem *>::Entry> entries;
+            entries.reserve(items.size());
+            for (SPItem *item : items) {
+                if (Geom::OptRect box = box_of(item)) {
+                    entries.emplace_back(*box, item);
                 }
-                if (!take_groups || is_layer) {
-                    continue;
+            }
+            index.tree.build(std::move(entries));
+            index.stale.clear();
+            index.changed.clear();
+            index.built = true;
+        }
+
+        index.tree.search(area, [&](SPItem *item) {
+            if (!index.stale.count(item)) {
+                f(order.at(item));
+            }
+        });
+        for (SPItem *item : index.changed) {
+            Geom::OptRect box = box_of(item);
+            if (box && box->intersects(area)) {
+                f(order.at(item));
+            }
+        }
+    }
+
+    template <typename F>
+    void searchArea(Geom::Rect const &area, F f)
+    {
+        search(area_index, area, [](SPItem *item) { return item->documentVisualBounds(); }, f);
+    }
+
+    /**
+     * Searches the drawing bounds of the items shown in a display key. They are kept in
+     * document coordinates, so that zooming and scrolling do not invalidate them. The boxes
+     * were rounded to pixels and some strokes are a pixel wide at any zoom: @a area should
+     * have a pixel of margin.
+     */
+    template <typename F>
+    void searchDrawing(unsigned dkey, Inkscape::DrawingItem *root, Geom::Rect const &area, F f)
+    {
+        Geom::Affine const to_document = root->ctm().inverse();
+        auto box_of = [=](SPItem *item) {
+            Geom::OptRect box;
+            if (Inkscape::DrawingItem *arenaitem = item->get_arenaitem(dkey)) {
+                // pick() tests one or the other depending on outline mode
+                Geom::OptIntRect drawing_box = arenaitem->geometricBounds();
+                drawing_box.unionWith(arenaitem->visualBounds());
+                if (drawing_box) {
+                    box = Geom::Rect(*drawing_box) * to_document;
                 }
             }
+            return box;
+        };
+        search(point_index[dkey], area * to_document, box_of, f);
+    }
+};
+
+SPDocument::ItemIndex &SPDocument::_getItemIndex() const
+{
+    if (!_item_index) {
+        _item_index.reset(new ItemIndex(SP_GROUP(this->root)));
+    }
+    _item_index->updateOrder();
+    return *_item_index;
+}
+
+void SPDocument::_itemAdded(SPObject *object)
+{
+    if (_item_index && is_indexed_item(object, root)) {
+        _item_index->itemAdded(SP_ITEM(object));
+    }
+}
+
+void SPDocument::_itemRemoved(SPObject *object)
+{
+    if (_item_index && is_indexed_item(object, root)) {
+        _item_index->itemRemoved(SP_ITEM(object));
+    }
+}
+
+void SPDocument::_itemReordered(SPObject *object)
+{
+    if (_item_index && is_indexed_item(object, root)) {
+        _item_index->order_dirty = true;
+    }
+}
+
+void SPDocument::_itemModified(SPObject *object)
+{
+    if (_item_index && is_indexed_item(object, root)) {
+        _item_index->itemModified(SP_ITEM(object));
+    }
+}
+
+/**
+ * Whether the search for items in an area reaches the item, i.e. it and its ancestors
+ * pass the filters and it is inside entered groups only.
+ */
+static bool is_reached_in_area(SPItem *item, SPGroup *root, unsigned int dkey,
+                               bool take_hidden, bool take_insensitive, bool take_groups, bool enter_groups)
+{
+    for (SPObject *o = item; o != root; o = o->parent) {
+        SPItem *ancestor = SP_ITEM(o);
+        if (!take_insensitive && ancestor->isLocked()) {
+            return false;
+        }
+        if (!take_hidden && ancestor->isHidden()) {
+            return false;
+        }
+        if (ancestor != item && !(enter_groups || SP_GROUP(ancestor)->effectiveLayerMode(dkey) == SPGroup::LAYER)) {
+            return false;
+        }
+    }
+    if (SPGroup *group = dynamic_cast<SPGroup *>(item)) {
+        if (!take_groups || group->effectiveLayerMode(dkey) == SPGroup::LAYER) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @param area Area in document coordinates
+ */
+static std::vector<SPItem*> find_items_in_area(SPDocument::ItemIndex &index,
+                                               SPGroup *root, unsigned int dkey,
+                                               Geom::Rect const &area,
+                                               bool (*test)(Geom::Rect const &, Geom::Rect const &),
+                                               bool take_hidden = false,
+                                               bool take_insensitive = false,
+                                               bool take_groups = true,
+                                               bool enter_groups = false)
+{
+    std::vector<unsigned> found;
+    index.searchArea(area, [&](unsigned i) { found.push_back(i); });
+    std::sort(found.begin(), found.end());
+
+    std::vector<SPItem*> s;
+    for (unsigned i : found) {
+        SPItem *item = index.items[i];
+        if (is_reached_in_area(item, root, dkey, take_hidden, take_insensitive, take_groups, enter_groups)) {
             Geom::OptRect box = item->documentVisualBounds();
             if (box && test(area, *box)) {
                 s.push_back(item);
@@ -1374,99 +1684,114 @@ SPItem *SPDocument::getItemFromListAtPointBottom(unsigned int dkey, SPGroup *gro
 }
 
 /**
-Turn the SVG DOM into a flat list of nodes that can be searched from top-down.
-The list can be persisted, which improves "find at multiple points" speed.
-*/
-// TODO: study add `gboolean with_groups = false` as parameter.
-void SPDocument::build_flat_item_list(unsigned int dkey, SPGroup *group, gboolean into_groups) const
+ * Whether the item is one picking at a point looks at: it is visible and unlocked, and
+ * all groups above it are entered (layers, or any group with into_groups) while it is not.
+ */
+static bool is_pickable(SPItem *item, SPGroup *root, unsigned int dkey, bool into_groups)
 {
-    for (auto& o: group->children) {
-        if (!SP_IS_ITEM(&o)) {
-            continue;
+    for (SPObject *o = item->parent; o && o != root; o = o->parent) {
+        if (!into_groups && SP_GROUP(o)->effectiveLayerMode(dkey) != SPGroup::LAYER) {
+            return false;
         }
-
-        if (SP_IS_GROUP(&o) && (SP_GROUP(&o)->effectiveLayerMode(dkey) == SPGroup::LAYER || into_groups)) {
-            build_flat_item_list(dkey, SP_GROUP(&o), into_groups);
-        } else {
-            SPItem *child = SP_ITEM(&o);
-            if (child->isVisibleAndUnlocked(dkey)) {
-                _node_cache.push_front(child);
-            }
+    }
+    if (SPGroup *group = dynamic_cast<SPGroup *>(item)) {
+        if (into_groups || group->effectiveLayerMode(dkey) == SPGroup::LAYER) {
+            return false;
         }
     }
+    return item->isVisibleAndUnlocked(dkey);
+}
+
+/**
+ * Indices of the items whose drawing box is within the pick tolerance of p, topmost first.
+ * Empty if the document is not shown in the display key.
+ */
+static std::vector<unsigned> find_pick_candidates(SPDocument::ItemIndex &index, SPGroup *root,
+                                                  unsigned int dkey, Geom::Point const &p, double delta)
+{
+    std::vector<unsigned> found;
+    Inkscape::DrawingItem *root_arenaitem = root->get_arenaitem(dkey);
+    if (!root_arenaitem) {
+        return found;
+    }
+    root_arenaitem->drawing().update();
+
+    Geom::Point const tolerance(delta + 1, delta + 1);
+    index.searchDrawing(dkey, root_arenaitem, Geom::Rect(p - tolerance, p + tolerance),
+                        [&](unsigned i) { found.push_back(i); });
+    std::sort(found.begin(), found.end(), std::greater<unsigned>());
+    return found;
 }
 
 /**
-Returns the topmost (in z-order) item from the descendants of group (recursively) which
-is at the point p, or NULL if none. Honors into_groups on whether to recurse into
-non-layer groups or not. Honors take_insensitive on whether to return insensitive
-items. If upto != NULL, then if item upto is encountered (at any level), stops searching
-upwards in z-order and returns what it has found so far (i.e. the found item is
-guaranteed to be lower than upto). Requires a list of nodes built by
-build_flat_item_list.
+Returns the topmost (in z-order) item from the descendants of root which is at the
+point p, or NULL if none. Honors into_groups on whether to recurse into non-layer
+groups or not. If upto != NULL, then if item upto is encountered (at any level),
+stops searching upwards in z-order and returns what it has found so far (i.e. the
+found item is guaranteed to be lower than upto).
  */
-static SPItem *find_item_at_point(std::deque<SPItem*> *nodes, unsigned int dkey, Geom::Point const &p, SPItem* upto=nullptr)
+static SPItem *find_item_at_point(SPDocument::ItemIndex &index, SPGroup *root, unsigned int dkey,
+                                  Geom::Point const &p, bool into_groups, SPItem* upto=nullptr)
 {
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
     gdouble delta = prefs->getDouble("/options/cursortolerance/value", 1.0);
 
-    SPItem *seen = nullptr;
-    SPItem *child;
-    bool seen_upto = (!upto);
-    for (std::deque<SPItem*>::const_iterator i = nodes->begin(); i != nodes->end(); ++i) {
-        child = *i;
-        if (!seen_upto){
-            if(child == upto)
-                seen_upto = true;
+    unsigned upto_order = index.items.size();
+    if (upto) {
+        auto found = index.order.find(upto);
+        if (found == index.order.end() || !is_pickable(upto, root, dkey, into_groups)) {
+            return nullptr;
+        }
+        upto_order = found->second;
+    }
+
+    for (unsigned i : find_pick_candidates(index, root, dkey, p, delta)) {
+        if (i >= upto_order) {
+            continue;
+        }
+        SPItem *child = index.items[i];
+        if (!is_pickable(child, root, dkey, into_groups)) {
             continue;
         }
         Inkscape::DrawingItem *arenaitem = child->get_arenaitem(dkey);
-        if (arenaitem) {
-            arenaitem->drawing().update();
-            if (arenaitem->pick(p, delta, 1) != nullptr) {
-                seen = child;
-                break;
-            }
+        if (arenaitem && arenaitem->pick(p, delta, 1) != nullptr) {
+            return child;
         }
     }
 
-    return seen;
+    return nullptr;
 }
 
 /**
-Returns the topmost non-layer group from the descendants of group which is at point
+Returns the topmost non-layer group from the descendants of root which is at point
 p, or NULL if none. Recurses into layers but not into groups.
  */
-static SPItem *find_group_at_point(unsigned int dkey, SPGroup *group, Geom::Point const &p)
+static SPItem *find_group_at_point(SPDocument::ItemIndex &index, SPGroup *root, unsigned int dkey, Geom::Point const &p)
 {
-    SPItem *seen = nullptr;
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
     gdouble delta = prefs->getDouble("/options/cursortolerance/value", 1.0);
 
-    for (auto& o: group->children) {
-        if (!SP_IS_ITEM(&o)) {
+    for (unsigned i : find_pick_candidates(index, root, dkey, p, delta)) {
+        SPGroup *group = dynamic_cast<SPGroup *>(index.items[i]);
+        if (!group || group->effectiveLayerMode(dkey) == SPGroup::LAYER) {
             continue;
         }
-        if (SP_IS_GROUP(&o) && SP_GROUP(&o)->effectiveLayerMode(dkey) == SPGroup::LAYER) {
-            SPItem *newseen = find_group_at_point(dkey, SP_GROUP(&o), p);
-            if (newseen) {
-                seen = newseen;
+        bool in_layers = true;
+        for (SPObject *o = group->parent; o && o != root; o = o->parent) {
+            if (SP_GROUP(o)->effectiveLayerMode(dkey) != SPGroup::LAYER) {
+                in_layers = false;
+                break;
             }
         }
-        if (SP_IS_GROUP(&o) && SP_GROUP(&o)->effectiveLayerMode(dkey) != SPGroup::LAYER ) {
-            SPItem *child = SP_ITEM(&o);
-            Inkscape::DrawingItem *arenaitem = child->get_arenaitem(dkey);
-            if (arenaitem) {
-                arenaitem->drawing().update();
-            }
-
-            // seen remembers the last (topmost) of groups pickable at this point
-            if (arenaitem && arenaitem->pick(p, delta, 1) != nullptr) {
-                seen = child;
-            }
+        if (!in_layers) {
+            continue;
+        }
+        Inkscape::DrawingItem *arenaitem = group->get_arenaitem(dkey);
+        if (arenaitem && arenaitem->pick(p, delta, 1) != nullptr) {
+            return group;
         }
     }
-    return seen;
+    return nullptr;
 }
 
 
@@ -1478,8 +1803,7 @@ static SPItem *find_group_at_point(unsigned int dkey, SPGroup *group, Geom::Poin
 
 std::vector<SPItem*> SPDocument::getItemsInBox(unsigned int dkey, Geom::Rect const &box, bool take_hidden, bool take_insensitive, bool take_groups, bool enter_groups) const
 {
-    std::vector<SPItem*> x;
-    return find_items_in_area(x, SP_GROUP(this->root), dkey, box, is_within, take_hidden, take_insensitive, take_groups, enter_groups);
+    return find_items_in_area(_getItemIndex(), SP_GROUP(this->root), dkey, box, is_within, take_hidden, take_insensitive, take_groups, enter_groups);
 }
 
 /**
@@ -1495,8 +1819,7 @@ std::vector<SPItem*> SPDocument::getItemsInBox(unsigned int dkey, Geom::Rect con
 
 std::vector<SPItem*> SPDocument::getItemsPartiallyInBox(unsigned int dkey, Geom::Rect const &box, bool take_hidden, bool take_insensitive, bool take_groups, bool enter_groups) const
 {
-    std::vector<SPItem*> x;
-    return find_items_in_area(x, SP_GROUP(this->root), dkey, box, overlaps, take_hidden, take_insensitive, take_groups, enter_groups);
+    return find_items_in_area(_getItemIndex(), SP_GROUP(this->root), dkey, box, overlaps, take_hidden, take_insensitive, take_groups, enter_groups);
 }
 
 std::vector<SPItem*> SPDocument::getItemsAtPoints(unsigned const key, std::vector<Geom::Point> points, bool all_layers, size_t limit) const
@@ -1510,12 +1833,7 @@ std::vector<SPItem*> SPDocument::getItemsAtPoints(unsigned const key, std::vecto
     gdouble saved_delta = prefs->getDouble("/options/cursortolerance/value", 1.0);
     prefs->setDouble("/options/cursortolerance/value", 0.25);
 
-    // Cache a flattened SVG DOM to speed up selection.
-    if(!_node_cache_valid){
-        _node_cache.clear();
-        build_flat_item_list(key, SP_GROUP(this->root), true);
-        _node_cache_valid=true;
-    }
+    ItemIndex &index = _getItemIndex();
     SPObject *current_layer = nullptr;
     SPDesktop *desktop = SP_ACTIVE_DESKTOP;
     Inkscape::LayerModel *layer_model = nullptr;
@@ -1525,7 +1843,7 @@ std::vector<SPItem*> SPDocument::getItemsAtPoints(unsigned const key, std::vecto
     }
     size_t item_counter = 0;
     for(int i = points.size()-1;i>=0; i--) {
-        SPItem *item = find_item_at_point(&_node_cache, key, points[i]);
+        SPItem *item = find_item_at_point(index, SP_GROUP(this->root), key, points[i], true);
         if (item && items.end()==find(items.begin(),items.end(), item))
             if(all_layers || (layer_model && layer_model->layerForObject(item) == current_layer)){
                 items.push_back(item);
@@ -1547,27 +1865,12 @@ std::vector<SPItem*> SPDocument::getItemsAtPoints(unsigned const key, std::vecto
 SPItem *SPDocument::getItemAtPoint( unsigned const key, Geom::Point const &p,
                                     bool const into_groups, SPItem *upto) const
 {
-    // Build a flattened SVG DOM for find_item_at_point.
-    std::deque<SPItem*> bak(_node_cache);
-    if(!into_groups){
-        _node_cache.clear();
-        build_flat_item_list(key, SP_GROUP(this->root), into_groups);
-    }
-    if(!_node_cache_valid && into_groups){
-        _node_cache.clear();
-        build_flat_item_list(key, SP_GROUP(this->root), true);
-        _node_cache_valid=true;
-    }
-
-    SPItem *res = find_item_at_point(&_node_cache, key, p, upto);
-    if(!into_groups)
-        _node_cache = bak;
-    return res;
+    return find_item_at_point(_getItemIndex(), SP_GROUP(this->root), key, p, into_groups, upto);
 }
 
 SPItem *SPDocument::getGroupAtPoint(unsigned int key, Geom::Point const &p) const
 {
-    return find_group_at_point(key, SP_GROUP(this->root), p);
+    return find_group_at_point(_getItemIndex(), SP_GROUP(this->root), key, p);
 }
 
 // Resource management
@@ -1995,7 +2298,6 @@ void SPDocument::_emitModified() {
     static guint const flags = SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_CHILD_MODIFIED_FLAG | SP_OBJECT_PARENT_MODIFIED_FLAG;
     root->emitModified(0);
     modified_signal.emit(flags);
-    _node_cache_valid=false;
 }
 
 void
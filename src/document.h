@@ -20,8 +20,8 @@
 
 
 #include <cstddef>
-#include <deque>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include <boost/ptr_container/ptr_list.hpp>
@@ -134,6 +134,7 @@ public:
     bool isModifiedSinceAutoSave() const { return modified_since_autosave; }
     void setModifiedSinceSave(bool const modified = true);
     void setModifiedSinceAutoSaveFalse() { modified_since_autosave = false; };
+    void setModifiedSinceAutoSaveTrue() { modified_since_autosave = true; };
 
     bool idle_handler();
     bool rerouting_handler();
@@ -142,6 +143,11 @@ public:
     bool _updateDocument(int flags); // Used by stand-alone sp_document_idle_handler
     int ensureUpToDate();
 
+    void _itemAdded(SPObject *object); // Used by SPObject when it attaches a child
+    void _itemRemoved(SPObject *object); // Used by SPObject when it detaches a child
+    void _itemReordered(SPObject *object); // Used by SPObject when it reorders a child
+    void _itemModified(SPObject *object); // Used by SPObject when it emits modified
+
     bool addResource(char const *key, SPObject *object);
     bool removeResource(char const *key, SPObject *object);
     std::vector<SPObject *> const getResourceList(char const *key);
@@ -241,7 +247,7 @@ public:
 
 
     // Find items by geometry --------------------
-    void build_flat_item_list(unsigned int dkey, SPGroup *group, gboolean into_groups) const;
+    struct ItemIndex;
 
     std::vector<SPItem*> getItemsInBox         (unsigned int dkey, Geom::Rect const &box, bool take_hidden = false, bool take_insensitive = false, bool take_groups = true, bool enter_groups = false) const;
     std::vector<SPItem*> getItemsPartiallyInBox(unsigned int dkey, Geom::Rect const &box, bool take_hidden = false, bool take_insensitive = false, bool take_groups = true, bool enter_groups = false) const;
@@ -328,8 +334,8 @@ private:
     std::map<Inkscape::XML::Node *, SPObject *> reprdef;
 
     // Find items by geometry --------------------
-    mutable std::deque<SPItem*> _node_cache; // Used to speed up search.
-    mutable bool _node_cache_valid;
+    mutable std::unique_ptr<ItemIndex> _item_index; // Used to speed up search.
+    ItemIndex &_getItemIndex() const;
 
     // Box tool ----------------------------
     Persp3D *current_persp3d; /**< Currently 'active' perspective (to which, e.g., newly created boxes are attached) */
@@ -342,6 +348,7 @@ private:
     bool sensitive; /* If we save actions to undo stack */
     Inkscape::XML::Event * partial; /* partial undo log when interrupted */
     int history_size;
+    std::size_t history_memory = 0; /* Memory held by the undo and redo stacks, see Inkscape::Event::memory */
     std::vector<Inkscape::Event *> undo; /* Undo stack of reprs */
     std::vector<Inkscape::Event *> redo; /* Redo stack of reprs */
 
@@ -354,6 +354,48 @@ EventLog::notifyClearRedoEvent()
     updateUndoVerbs();
 }
 
+void
+EventLog::notifyUndoExpiredEvent(Event *log)
+{
+    auto &_columns = getColumns();
+
+    // the oldest event follows the initial pseudo event
+    iterator expired = _event_list_store->children().begin();
+    ++expired;
+    g_return_if_fail ( expired != _event_list_store->children().end() && (*expired)[_columns.event] == log );
+
+    // the saved state can't be returned to anymore
+    if ( _last_saved == _event_list_store->children().begin() || _last_saved == expired ) {
+        _last_saved = (iterator)nullptr;
+    }
+
+    if ( expired->children().empty() ) {
+        _event_list_store->erase(expired);
+    } else {
+        // move the first event of the branch up to take the place of the expired one
+        iterator first = expired->children().begin();
+
+        (*expired)[_columns.event] = (Event *)(*first)[_columns.event];
+        (*expired)[_columns.description] = (Glib::ustring)(*first)[_columns.description];
+        (*expired)[_columns.child_count] = expired->children().size();
+
+        if ( _curr_event == first ) {
+            _curr_event = expired;
+            _curr_event_parent = (iterator)nullptr;
+        }
+        if ( _last_event == first ) {
+            _last_event = expired;
+        }
+        if ( _last_saved == first ) {
+            _last_saved = expired;
+        }
+
+        _event_list_store->erase(first);
+    }
+
+    updateUndoVerbs();
+}
+
 void  EventLog::addDialogConnection(Gtk::TreeView *event_list_view, CallbackMap *callback_connections)
 {
     _priv->addDialogConnection(event_list_view, callback_connections, _event_list_store, _curr_event);
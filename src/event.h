@@ -40,6 +40,8 @@ struct Event {
     XML::Event *event;
     const unsigned int type;
     Glib::ustring description;
+    /// Approximate memory held by the event log, kept up to date by DocumentUndo
+    std::size_t memory = 0;
 };
 
 } // namespace Inkscape
@@ -156,7 +156,15 @@ DB::get (const gchar *key)
 {
         if (key == nullptr) return nullptr;
 
-	Extension *mod = moduledict[key];
+	auto it = moduledict.find(key);
+	if (it == moduledict.end() && deferred_loader) {
+		load_deferred();
+		it = moduledict.find(key);
+	}
+	if (it == moduledict.end())
+		return nullptr;
+
+	Extension *mod = it->second;
 	if ( !mod || mod->deactivated() )
 		return nullptr;
 
@@ -175,6 +183,21 @@ DB::get (const gchar *key)
 */
 void
 DB::foreach (void (*in_func)(Extension * in_plug, gpointer in_data), gpointer in_data)
+{
+	load_deferred();
+	foreach_loaded(in_func, in_data);
+}
+
+/**
+	\brief     Like foreach(), but only for the modules loaded so far,
+	           without loading the deferred ones.
+
+	The modules loaded so far come first in the order of foreach(),
+	so a search that finds what it is looking for among them finds
+	the same module as a search through all of them.
+*/
+void
+DB::foreach_loaded (void (*in_func)(Extension * in_plug, gpointer in_data), gpointer in_data)
 {
 	std::list <Extension *>::iterator cur;
 
@@ -184,6 +207,30 @@ DB::foreach (void (*in_func)(Extension * in_plug, gpointer in_data), gpointer in
 	}
 }
 
+/**
+	\brief     Sets a function registering more modules, which is only called
+	           when a module that is not loaded yet could be needed.
+	\param     loader  The function registering the modules
+*/
+void
+DB::defer_loading (void (*loader)())
+{
+	deferred_loader = loader;
+}
+
+/**
+	\brief     Registers the modules whose loading was deferred, if not done yet.
+*/
+void
+DB::load_deferred ()
+{
+	if (deferred_loader) {
+		auto loader = deferred_loader;
+		deferred_loader = nullptr;
+		loader();
+	}
+}
+
 /**
 	\return    none
 	\brief     The function to look at each module and see if it is
@@ -53,6 +53,9 @@ private:
         lists via "foreach" */
     std::list <Extension *> modulelist;
 
+    /** Loads the modules that are only needed once one of them is looked up */
+    void (*deferred_loader)() = nullptr;
+
     static void foreach_internal (gpointer in_key, gpointer in_value, gpointer in_data);
 
 public:
@@ -61,6 +64,9 @@ public:
     void register_ext (Extension *module);
     void unregister_ext (Extension *module);
     void foreach (void (*in_func)(Extension * in_plug, gpointer in_data), gpointer in_data);
+    void foreach_loaded (void (*in_func)(Extension * in_plug, gpointer in_data), gpointer in_data);
+    void defer_loading (void (*loader)());
+    void load_deferred ();
 
 private:
     static void input_internal (Extension * in_plug, gpointer data);
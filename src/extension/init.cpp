@@ -62,6 +62,7 @@
 #include "internal/cdr-input.h"
 #endif
 #include "preferences.h"
+#include "debug/startup-profile.h"
 #include "io/sys.h"
 #include "io/resource.h"
 #ifdef WITH_DBUS
@@ -121,6 +122,7 @@ namespace Extension {
 #define SP_MODULE_EXTENSION  "inx"
 
 static void check_extensions();
+static void init_deferred();
 
 /**
  * \return    none
@@ -182,15 +184,44 @@ init()
     Internal::CdrInput::init();
 #endif
 
+#ifdef WITH_DBUS
+    Dbus::init();
+#endif
+
+    /* Without a GUI, effects and the extensions in .inx files are only
+     * loaded when something looks for a module that isn't loaded yet,
+     * which most command line exports never do. The GUI needs them right
+     * away: effects add themselves to the menus when they are created, and
+     * the Extensions and Filters menus are built only once.
+     */
+    if (Inkscape::Application::exists() && !INKSCAPE.use_gui()) {
+        db.defer_loading(init_deferred);
+    } else {
+        init_deferred();
+    }
+
+    /* This is a hack to deal with updating saved outdated module
+     * names in the prefs...
+     */
+    update_pref("/dialogs/save_as/default",
+                SP_MODULE_KEY_OUTPUT_SVG_INKSCAPE
+                // Inkscape::Extension::db.get_output_list()
+        );
+}
+
+/**
+ * Loads the effects and the extensions described in .inx files.
+ */
+static void
+init_deferred()
+{
+    Debug::StartupStage stage("load extensions");
+
     /* Effects */
     Internal::BlurEdge::init();
     Internal::GimpGrad::init();
     Internal::Grid::init();
 
-#ifdef WITH_DBUS
-    Dbus::init();
-#endif
-
     /* Raster Effects */
 #ifdef WITH_MAGICK
     Magick::InitializeMagick(NULL);
@@ -246,14 +277,6 @@ init()
 
     /* now we need to check and make sure everyone is happy */
     check_extensions();
-
-    /* This is a hack to deal with updating saved outdated module
-     * names in the prefs...
-     */
-    update_pref("/dialogs/save_as/default",
-                SP_MODULE_KEY_OUTPUT_SVG_INKSCAPE
-                // Inkscape::Extension::db.get_output_list()
-        );
 }
 
 static void
@@ -28,6 +28,7 @@
 
 #include <csignal>
 #include <cerrno>
+#include <cstring>
 #include <2geom/pathvector.h>
 
 #include <glib.h>
@@ -137,6 +138,9 @@ CairoRenderContext::~CairoRenderContext()
 {
     for (std::map<gpointer, cairo_font_face_t *>::const_iterator iter = font_table.begin(); iter != font_table.end(); ++iter)
         font_data_free(iter->second);
+    for (auto &glyph_path : _glyph_paths)
+        cairo_path_destroy(glyph_path.second);
+    if (_glyph_cr) cairo_destroy(_glyph_cr);
 
     if (_cr) cairo_destroy(_cr);
     if (_surface) cairo_surface_destroy(_surface);
@@ -477,6 +481,45 @@ CairoRenderContext::saveAsPng(const char *file_name)
         return true;
 }
 
+void
+CairoRenderContext::newPage(double width, double height)
+{
+    g_assert( _is_valid );
+
+    if (!_vector_based_target)
+        return;
+
+    cairo_show_page(_cr);
+
+    _width = width;
+    _height = height;
+    switch (_target) {
+#ifdef CAIRO_HAS_PDF_SURFACE
+        case CAIRO_SURFACE_TYPE_PDF:
+            cairo_pdf_surface_set_size(_surface, width, height);
+            break;
+#endif
+#ifdef CAIRO_HAS_PS_SURFACE
+        case CAIRO_SURFACE_TYPE_PS:
+            cairo_ps_surface_set_size(_surface, width, height);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    // start over from the transform of a fresh surface
+    cairo_identity_matrix(_cr);
+    cairo_scale(_cr, Inkscape::Util::Quantity::convert(1, "px", "pt"), Inkscape::Util::Quantity::convert(1, "px", "pt"));
+    _state->transform = getTransform();
+
+    // the finished page is written out by cairo_show_page(), hand it on before rendering the next one
+    cairo_surface_flush(_surface);
+    if (_stream) {
+        (void) fflush(_stream);
+    }
+}
+
 void
 CairoRenderContext::setRenderMode(CairoRenderMode mode)
 {
@@ -1627,6 +1670,43 @@ CairoRenderContext::renderPathVector(Geom::PathVector const & pathv, SPStyle con
     return true;
 }
 
+/**
+ * Tags @a surface with a checksum of its pixels. Cairo writes all surfaces with the same
+ * unique ID only once, so an image is embedded once however many <image> elements show it.
+ * The ID stays on the surface until its pixels are marked dirty.
+ */
+static void set_surface_unique_id(cairo_surface_t *surface)
+{
+#ifdef CAIRO_MIME_TYPE_UNIQUE_ID
+    unsigned char const *id = nullptr;
+    unsigned long id_len = 0;
+    cairo_surface_get_mime_data(surface, CAIRO_MIME_TYPE_UNIQUE_ID, &id, &id_len);
+    if (id) {
+        return;
+    }
+
+    cairo_surface_flush(surface);
+    int const w = cairo_image_surface_get_width(surface);
+    int const h = cairo_image_surface_get_height(surface);
+    int const stride = cairo_image_surface_get_stride(surface);
+    unsigned char const *data = cairo_image_surface_get_data(surface);
+    if (!data) {
+        return;
+    }
+
+    // row by row, so that padding does not count
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA1);
+    for (int y = 0; y < h; ++y) {
+        g_checksum_update(checksum, data + y * stride, 4 * w);
+    }
+    gchar *unique_id = g_strdup_printf("inkscape-image-%dx%d-%s", w, h, g_checksum_get_string(checksum));
+    g_checksum_free(checksum);
+
+    cairo_surface_set_mime_data(surface, CAIRO_MIME_TYPE_UNIQUE_ID, (unsigned char *) unique_id,
+                                strlen(unique_id), g_free, unique_id);
+#endif
+}
+
 bool CairoRenderContext::renderImage(Inkscape::Pixbuf *pb,
                                      Geom::Affine const &image_transform, SPStyle const *style)
 {
@@ -1649,6 +1729,10 @@ bool CairoRenderContext::renderImage(Inkscape::Pixbuf *pb,
         return false;
     }
 
+    if (_vector_based_target) {
+        set_surface_unique_id(image_surface);
+    }
+
     cairo_save(_cr);
 
     // scaling by width & height is not needed because it will be done by Cairo
@@ -1732,7 +1816,20 @@ unsigned int CairoRenderContext::_showGlyphs(cairo_t *cr, PangoFont * /*font*/,
     }
 
     if (path) {
-        cairo_glyph_path(cr, glyphs, num_glyphs - num_invalid_glyphs);
+        // Add the outline of each glyph at its position, instead of having cairo
+        // look up every glyph again (see _glyphPath).
+        cairo_matrix_t ctm;
+        cairo_get_matrix(cr, &ctm);
+        for (unsigned int j = 0; j < num_glyphs - num_invalid_glyphs; j++) {
+            cairo_path_t *glyph_path = _glyphPath(cr, glyphs[j].index);
+            if (!glyph_path) {
+                cairo_glyph_path(cr, &glyphs[j], 1);
+                continue;
+            }
+            cairo_translate(cr, glyphs[j].x, glyphs[j].y);
+            cairo_append_path(cr, glyph_path);
+            cairo_set_matrix(cr, &ctm);
+        }
     } else {
         cairo_show_glyphs(cr, glyphs, num_glyphs - num_invalid_glyphs);
     }
@@ -1744,6 +1841,54 @@ unsigned int CairoRenderContext::_showGlyphs(cairo_t *cr, PangoFont * /*font*/,
     return num_glyphs - num_invalid_glyphs;
 }
 
+/**
+ * Returns the outline of a glyph in the font face and font matrix set on @a cr, with the
+ * glyph origin at (0, 0) in user space. The outlines are kept for the whole export, so that
+ * text converted to paths only has each glyph of each font and size looked up once.
+ */
+cairo_path_t *
+CairoRenderContext::_glyphPath(cairo_t *cr, unsigned long index)
+{
+    cairo_font_face_t *font_face = cairo_get_font_face(cr);
+    cairo_matrix_t font_matrix;
+    cairo_get_font_matrix(cr, &font_matrix);
+
+    GlyphKey key(font_face, font_matrix.xx, font_matrix.yx, font_matrix.xy, font_matrix.yy,
+                 font_matrix.x0, font_matrix.y0, index);
+    auto found = _glyph_paths.find(key);
+    if (found != _glyph_paths.end()) {
+        return found->second;
+    }
+
+    if (!_glyph_cr) {
+        cairo_surface_t *scratch = cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1);
+        _glyph_cr = cairo_create(scratch);
+        cairo_surface_destroy(scratch);
+
+        // Outlines must come out as they would on the target surface, e.g. without hinting
+        cairo_font_options_t *options = cairo_font_options_create();
+        cairo_surface_get_font_options(cairo_get_target(cr), options);
+        cairo_set_font_options(_glyph_cr, options);
+        cairo_font_options_destroy(options);
+    }
+
+    cairo_set_font_face(_glyph_cr, font_face);
+    cairo_set_font_matrix(_glyph_cr, &font_matrix);
+    cairo_new_path(_glyph_cr);
+    cairo_glyph_t glyph = { index, 0.0, 0.0 };
+    cairo_glyph_path(_glyph_cr, &glyph, 1);
+
+    cairo_path_t *glyph_path = cairo_copy_path(_glyph_cr);
+    cairo_new_path(_glyph_cr);
+    if (glyph_path->status != CAIRO_STATUS_SUCCESS) {
+        cairo_path_destroy(glyph_path);
+        return nullptr;
+    }
+
+    _glyph_paths[key] = glyph_path;
+    return glyph_path;
+}
+
 bool
 CairoRenderContext::renderGlyphtext(PangoFont *font, Geom::Affine const &font_matrix,
                                     std::vector<CairoGlyphInfo> const &glyphtext, SPStyle const *style)
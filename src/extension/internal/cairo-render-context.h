@@ -15,8 +15,10 @@
  */
 
 #include "extension/extension.h"
+#include <map>
 #include <set>
 #include <string>
+#include <tuple>
 
 #include <2geom/forward.h>
 #include <2geom/affine.h>
@@ -125,8 +127,9 @@ public:
     /** Saves the contents of the context to a PNG file. */
     bool saveAsPng(const char *file_name);
 
-    /** On targets supporting multiple pages, sends subsequent rendering to a new page*/
-    void newPage();
+    /** On targets supporting multiple pages, emits the current page and sends
+    subsequent rendering to a new page of the given size. */
+    void newPage(double width, double height);
 
     /* Render/clip mode setting/query */
     void setRenderMode(CairoRenderMode mode);
@@ -228,6 +231,7 @@ protected:
     cairo_pattern_t *_createHatchPainter(SPPaintServer const *const paintserver, Geom::OptRect const &pbox);
 
     unsigned int _showGlyphs(cairo_t *cr, PangoFont *font, std::vector<CairoGlyphInfo> const &glyphtext, bool is_stroke);
+    cairo_path_t *_glyphPath(cairo_t *cr, unsigned long index);
 
     bool _finishSurfaceSetup(cairo_surface_t *surface, cairo_matrix_t *ctm = nullptr);
     void _setSurfaceMetadata(cairo_surface_t *surface);
@@ -245,6 +249,11 @@ protected:
     std::map<gpointer, cairo_font_face_t *> font_table;
     static void font_data_free(gpointer data);
 
+    /** Glyph outlines relative to the glyph origin, by font face, font matrix and glyph index */
+    typedef std::tuple<cairo_font_face_t *, double, double, double, double, double, double, unsigned long> GlyphKey;
+    std::map<GlyphKey, cairo_path_t *> _glyph_paths;
+    cairo_t *_glyph_cr = nullptr; ///< Used to get glyph outlines
+
     CairoRenderState *_createState();
 };
 
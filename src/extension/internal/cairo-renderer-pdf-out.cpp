@@ -18,6 +18,9 @@
 #include <cairo.h>
 #ifdef CAIRO_HAS_PDF_SURFACE
 
+#include <vector>
+#include <glibmm/regex.h>
+
 #include "cairo-renderer-pdf-out.h"
 #include "cairo-render-context.h"
 #include "cairo-renderer.h"
@@ -32,6 +35,7 @@
 #include "display/curve.h"
 #include "display/canvas-bpath.h"
 #include "object/sp-item.h"
+#include "object/sp-item-group.h"
 #include "object/sp-root.h"
 
 #include <2geom/affine.h>
@@ -54,41 +58,85 @@ bool CairoRendererPdfOutput::check(Inkscape::Extension::Extension * /*module*/)
     return result;
 }
 
+/**
+ * Renders the top-level items of @a root on a page: @a layer, and whatever is not in a layer.
+ */
+static void
+pdf_render_layer_page(CairoRenderer *renderer, CairoRenderContext *ctx, SPRoot *root, SPItem *layer)
+{
+    // mirrors sp_root_render(), minus the other layers
+    ctx->pushState();
+    renderer->setStateForItem(ctx, root);
+    ctx->transform(root->c2p);
+    for (auto &child : root->children) {
+        SPItem *item = dynamic_cast<SPItem *>(&child);
+        if (item && (item == layer || !SP_IS_LAYER(item))) {
+            renderer->renderItem(ctx, item);
+        }
+    }
+    ctx->popState();
+}
+
+/**
+ * Writes @a doc to a PDF file.
+ *
+ * Several pages are written when @a exportId lists several objects separated by ';', one for
+ * each object, or when @a layersAsPages is set, one for each visible top-level layer. Each
+ * page is emitted, and the bitmaps rendered for it are freed, before the next one is rendered.
+ */
 static bool
 pdf_render_document_to_file(SPDocument *doc, gchar const *filename, unsigned int level,
                             bool texttopath, bool omittext, bool filtertobitmap, int resolution,
-                            const gchar * const exportId, bool exportDrawing, bool exportCanvas, float bleedmargin_px)
+                            const gchar * const exportId, bool exportDrawing, bool exportCanvas, float bleedmargin_px,
+                            bool layersAsPages)
 {
     doc->ensureUpToDate();
 
 /* Start */
 
-    SPItem *base = nullptr;
+    SPRoot *root = doc->getRoot();
+    std::vector<SPItem *> pages;
+    std::vector<SPItem *> layers;
 
     bool pageBoundingBox = TRUE;
     if (exportId && strcmp(exportId, "")) {
-        // we want to export the given item only
-        base = SP_ITEM(doc->getObjectById(exportId));
-        if (!base) {
-            throw Inkscape::Extension::Output::export_id_not_found(exportId);
+        // we want to export the given items only
+        for (auto const &id : Glib::Regex::split_simple("\\s*;\\s*", exportId)) {
+            if (id.empty()) {
+                continue;
+            }
+            SPItem *item = dynamic_cast<SPItem *>(doc->getObjectById(id));
+            if (!item) {
+                throw Inkscape::Extension::Output::export_id_not_found(exportId);
+            }
+            pages.push_back(item);
         }
         pageBoundingBox = exportCanvas;
     }
     else {
         // we want to export the entire document from root
-        base = doc->getRoot();
+        if (root) {
+            pages.push_back(root);
+            if (layersAsPages) {
+                for (auto &child : root->children) {
+                    SPItem *item = dynamic_cast<SPItem *>(&child);
+                    if (item && SP_IS_LAYER(item) && !item->isHidden()) {
+                        layers.push_back(item);
+                    }
+                }
+            }
+        }
         pageBoundingBox = !exportDrawing;
     }
 
-    if (!base) {
+    if (pages.empty()) {
         return false;
     }
-    
+
     /* Create new arena */
     Inkscape::Drawing drawing;
     drawing.setExact(true);
     unsigned dkey = SPItem::display_key_new(1);
-    base->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY);
 
     /* Create renderer and context */
     CairoRenderer *renderer = new CairoRenderer();
@@ -100,16 +148,45 @@ pdf_render_document_to_file(SPDocument *doc, gchar const *filename, unsigned int
     ctx->setBitmapResolution(resolution);
 
     bool ret = ctx->setPdfTarget (filename);
-    if(ret) {
+    if (ret && !layers.empty()) {
+        /* Render each layer on its own page */
+        root->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY);
+        for (std::size_t i = 0; i < layers.size(); ++i) {
+            SPItem *layer = layers[i];
+            if (i == 0) {
+                ret = renderer->setupDocument(ctx, doc, pageBoundingBox, bleedmargin_px, layer);
+            } else {
+                renderer->releaseBitmaps();
+                ret = renderer->setupPage(ctx, doc, pageBoundingBox, bleedmargin_px, layer);
+            }
+            if (!ret) {
+                break;
+            }
+            pdf_render_layer_page(renderer, ctx, root, layer);
+        }
+        root->invoke_hide(dkey);
+    } else if (ret) {
         /* Render document */
-        ret = renderer->setupDocument(ctx, doc, pageBoundingBox, bleedmargin_px, base);
-        if (ret) {
+        for (std::size_t i = 0; i < pages.size(); ++i) {
+            SPItem *base = pages[i];
+            if (i == 0) {
+                ret = renderer->setupDocument(ctx, doc, pageBoundingBox, bleedmargin_px, base);
+            } else {
+                renderer->releaseBitmaps();
+                ret = renderer->setupPage(ctx, doc, pageBoundingBox, bleedmargin_px, base);
+            }
+            if (!ret) {
+                break;
+            }
+            // only the page being rendered is shown
+            base->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY);
             renderer->renderItem(ctx, base);
-            ret = ctx->finish();
+            base->invoke_hide(dkey);
         }
     }
-
-    base->invoke_hide(dkey);
+    if (ret) {
+        ret = ctx->finish();
+    }
 
     renderer->destroyContext(ctx);
     delete renderer;
@@ -204,13 +281,22 @@ CairoRendererPdfOutput::save(Inkscape::Extension::Output *mod, SPDocument *doc,
         g_warning("Parameter <bleed> might not exist");
     }
 
+    bool new_layersAsPages = false;
+    try {
+        new_layersAsPages = mod->get_param_bool("layersAsPages");
+    }
+    catch(...) {
+        g_warning("Parameter <layersAsPages> might not exist");
+    }
+
     // Create PDF file
     {
         gchar * final_name;
         final_name = g_strdup_printf("> %s", filename);
         ret = pdf_render_document_to_file(doc, final_name, level,
                                           new_textToPath, new_textToLaTeX, new_blurToBitmap, new_bitmapResolution,
-                                          new_exportId, new_exportDrawing, new_exportCanvas, new_bleedmargin_px);
+                                          new_exportId, new_exportDrawing, new_exportCanvas, new_bleedmargin_px,
+                                          new_layersAsPages && !new_textToLaTeX);
         g_free(final_name);
 
         if (!ret)
@@ -259,6 +345,7 @@ CairoRendererPdfOutput::init ()
             "</param>"
             "<param name=\"bleed\" gui-text=\"" N_("Bleed/margin (mm):") "\" type=\"float\" min=\"-10000\" max=\"10000\">0</param>\n"
             "<param name=\"exportId\" gui-text=\"" N_("Limit export to the object with ID:") "\" type=\"string\"></param>\n"
+            "<param name=\"layersAsPages\" gui-text=\"" N_("Export each layer as a page") "\" type=\"bool\">false</param>\n"
             "<output>\n"
                 "<extension>.pdf</extension>\n"
                 "<mimetype>application/pdf</mimetype>\n"
@@ -28,6 +28,7 @@
 
 #include <csignal>
 #include <cerrno>
+#include <cstring>
 
 
 #include <2geom/transforms.h>
@@ -49,14 +50,16 @@
 #include "document.h"
 #include "inkscape-version.h"
 #include "rdf.h"
+#include "style.h"
 
 #include "display/cairo-utils.h"
 #include "display/canvas-bpath.h"
 #include "display/curve.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
 
 #include "extension/system.h"
 
-#include "helper/pixbuf-ops.h"
 #include "helper/png-write.h"
 
 #include "io/sys.h"
@@ -107,6 +110,77 @@ CairoRenderer::~CairoRenderer()
     return;
 }
 
+Inkscape::Pixbuf *
+CairoRenderer::renderBitmap(SPItem *item, Geom::Rect const &area, unsigned width, unsigned height, double res)
+{
+    if (width == 0 || height == 0) return nullptr;
+
+    // Showing the document takes longer than rendering a single item, so it is only done once
+    if (!_bitmap_drawing || _bitmap_drawing->document() != item->document) {
+        _bitmap_drawing.reset(new Inkscape::ExportDrawing(item->document));
+    }
+    Inkscape::Drawing &drawing = _bitmap_drawing->drawing();
+
+    Geom::Scale scale(Inkscape::Util::Quantity::convert(res, "px", "in"));
+    drawing.root()->setTransform(scale * Geom::Translate(-area.min() * scale));
+
+    _bitmap_drawing->showOnly(std::vector<SPItem*>(1, item));
+
+    // The opacity is applied when the bitmap is rendered to the output. The transform may
+    // have been changed since the document was shown, as for markers.
+    Inkscape::DrawingItem *arenaitem = item->get_arenaitem(_bitmap_drawing->key());
+    if (arenaitem) {
+        arenaitem->setOpacity(1.0);
+        arenaitem->setTransform(item->transform);
+    }
+
+    Geom::IntRect final_bbox = Geom::IntRect::from_xywh(0, 0, width, height);
+    drawing.update(final_bbox);
+
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    if (cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS) {
+        Inkscape::DrawingContext dc(surface, Geom::Point(0,0));
+        drawing.render(dc, final_bbox, Inkscape::DrawingItem::RENDER_BYPASS_CACHE);
+    }
+
+    if (arenaitem) {
+        arenaitem->setOpacity(SP_SCALE24_TO_FLOAT(item->style->opacity.value));
+    }
+
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        long long size = (long long) height * (long long) cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+        g_warning("CairoRenderer::renderBitmap: not enough memory to create pixel buffer. Need %lld.", size);
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+    cairo_surface_flush(surface);
+
+    // Repeated elements, e.g. with the same drop shadow, give identical bitmaps.
+    // Reusing the same surface for them makes cairo write the image only once.
+    unsigned char const *data = cairo_image_surface_get_data(surface);
+    std::size_t const size = (std::size_t) cairo_image_surface_get_stride(surface) * height;
+    std::uint64_t hash = 14695981039346656037ULL; // FNV-1a
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+
+    auto range = _bitmaps.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        cairo_surface_t *other = it->second->getSurfaceRaw();
+        if (cairo_image_surface_get_width(other) == (int) width &&
+            cairo_image_surface_get_height(other) == (int) height &&
+            memcmp(cairo_image_surface_get_data(other), data, size) == 0)
+        {
+            cairo_surface_destroy(surface);
+            return it->second.get();
+        }
+    }
+
+    Inkscape::Pixbuf *pb = new Inkscape::Pixbuf(surface);
+    _bitmaps.insert(std::make_pair(hash, std::unique_ptr<Inkscape::Pixbuf>(pb)));
+    return pb;
+}
+
 CairoRenderContext*
 CairoRenderer::createContext()
 {
@@ -355,6 +429,7 @@ static void sp_flowtext_render(SPFlowtext *flowtext, CairoRenderContext *ctx)
 
 static void sp_image_render(SPImage *image, CairoRenderContext *ctx)
 {
+    image->ensurePixbuf();
     if (!image->pixbuf) {
         return;
     }
@@ -383,7 +458,7 @@ static void sp_image_render(SPImage *image, CairoRenderContext *ctx)
     Geom::Scale s(width / (double)w, height / (double)h);
     Geom::Affine t(s * tp);
 
-    ctx->renderImage(image->pixbuf, t, image->style);
+    ctx->renderImage(image->pixbuf.get(), t, image->style);
 }
 
 static void sp_anchor_render(SPAnchor *a, CairoRenderContext *ctx)
@@ -523,17 +598,12 @@ static void sp_asbitmap_render(SPItem *item, CairoRenderContext *ctx)
     Geom::Affine t = t_on_document * t_item.inverse();
 
     // Do the export
-    SPDocument *document = item->document;
-
-    std::unique_ptr<Inkscape::Pixbuf> pb(
-        sp_generate_internal_bitmap(document, nullptr,
-            bbox->min()[Geom::X], bbox->min()[Geom::Y], bbox->max()[Geom::X], bbox->max()[Geom::Y],
-            width, height, res, res, (guint32) 0xffffff00, item ));
+    Inkscape::Pixbuf *pb = ctx->getRenderer()->renderBitmap(item, *bbox, width, height, res);
 
     if (pb) {
         //TEST(gdk_pixbuf_save( pb, "bitmap.png", "png", NULL, NULL ));
 
-        ctx->renderImage(pb.get(), t, item->style);
+        ctx->renderImage(pb, t, item->style);
     }
 }
 
@@ -715,22 +785,10 @@ CairoRenderer::setupDocument(CairoRenderContext *ctx, SPDocument *doc, bool page
 
     g_assert( ctx != nullptr );
 
-    if (!base) {
-        base = doc->getRoot();
-    }
-
     Geom::Rect d;
-    if (pageBoundingBox) {
-        d = Geom::Rect::from_xywh(Geom::Point(0,0), doc->getDimensions());
-    } else {
-        Geom::OptRect bbox = base->documentVisualBounds();
-        if (!bbox) {
-            g_message("CairoRenderer: empty bounding box.");
-            return false;
-        }
-        d = *bbox;
+    if (!pageArea(doc, pageBoundingBox, bleedmargin_px, base, d)) {
+        return false;
     }
-    d.expandBy(bleedmargin_px);
 
     double px_to_ctx_units = 1.0;
     if (ctx->_vector_based_target) {
@@ -748,20 +806,78 @@ CairoRenderer::setupDocument(CairoRenderContext *ctx, SPDocument *doc, bool page
     bool ret = ctx->setupSurface(ctx->_width, ctx->_height);
 
     if (ret) {
-        if (pageBoundingBox) {
-            // translate to set bleed/margin
-            Geom::Affine tp( Geom::Translate( bleedmargin_px, bleedmargin_px ) );
-            ctx->transform(tp);
-        } else {
-            // this transform translates the export drawing to a virtual page (0,0)-(width,height)
-            Geom::Affine tp(Geom::Translate(-d.min()));
-            ctx->transform(tp);
-        }
+        pageTransform(ctx, d, pageBoundingBox, bleedmargin_px);
     }
 
     return ret;
 }
 
+bool
+CairoRenderer::setupPage(CairoRenderContext *ctx, SPDocument *doc, bool pageBoundingBox, float bleedmargin_px, SPItem *base)
+{
+    g_assert( ctx != nullptr && ctx->_is_valid );
+
+    Geom::Rect d;
+    if (!pageArea(doc, pageBoundingBox, bleedmargin_px, base, d)) {
+        return false;
+    }
+
+    double px_to_ctx_units = 1.0;
+    if (ctx->_vector_based_target) {
+        px_to_ctx_units = Inkscape::Util::Quantity::convert(1, "px", "pt");
+    }
+
+    TRACE(("setupPage: %f x %f\n", d.width() * px_to_ctx_units, d.height() * px_to_ctx_units));
+
+    ctx->newPage(d.width() * px_to_ctx_units, d.height() * px_to_ctx_units);
+    pageTransform(ctx, d, pageBoundingBox, bleedmargin_px);
+
+    return true;
+}
+
+void
+CairoRenderer::releaseBitmaps()
+{
+    _bitmaps.clear();
+    _bitmap_drawing.reset();
+}
+
+bool
+CairoRenderer::pageArea(SPDocument *doc, bool pageBoundingBox, float bleedmargin_px, SPItem *base, Geom::Rect &area)
+{
+    if (!base) {
+        base = doc->getRoot();
+    }
+
+    if (pageBoundingBox) {
+        area = Geom::Rect::from_xywh(Geom::Point(0,0), doc->getDimensions());
+    } else {
+        Geom::OptRect bbox = base->documentVisualBounds();
+        if (!bbox) {
+            g_message("CairoRenderer: empty bounding box.");
+            return false;
+        }
+        area = *bbox;
+    }
+    area.expandBy(bleedmargin_px);
+
+    return true;
+}
+
+void
+CairoRenderer::pageTransform(CairoRenderContext *ctx, Geom::Rect const &area, bool pageBoundingBox, float bleedmargin_px)
+{
+    if (pageBoundingBox) {
+        // translate to set bleed/margin
+        Geom::Affine tp( Geom::Translate( bleedmargin_px, bleedmargin_px ) );
+        ctx->transform(tp);
+    } else {
+        // this transform translates the export drawing to a virtual page (0,0)-(width,height)
+        Geom::Affine tp(Geom::Translate(-area.min()));
+        ctx->transform(tp);
+    }
+}
+
 // Apply an SVG clip path
 void
 CairoRenderer::applyClipPath(CairoRenderContext *ctx, SPClipPath const *cp)
@@ -16,9 +16,14 @@
  */
 
 #include "extension/extension.h"
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
 
+#include <2geom/forward.h>
+
 //#include "libnrtype/font-instance.h"
 #include <cairo.h>
 
@@ -28,6 +33,9 @@ class SPMask;
 class SPHatchPath;
 
 namespace Inkscape {
+class ExportDrawing;
+class Pixbuf;
+
 namespace Extension {
 namespace Internal {
 
@@ -52,13 +60,36 @@ public:
     before setupDocument. */
     bool setupDocument(CairoRenderContext *ctx, SPDocument *doc, bool pageBoundingBox, float bleedmargin_px, SPItem *base);
 
+    /** Emits the page rendered so far and sets up the context for a new page
+    showing @a base, sized as setupDocument would. */
+    bool setupPage(CairoRenderContext *ctx, SPDocument *doc, bool pageBoundingBox, float bleedmargin_px, SPItem *base);
+
     /** Traverses the object tree and invokes the render methods. */
     void renderItem(CairoRenderContext *ctx, SPItem *item);
     void renderHatchPath(CairoRenderContext *ctx, SPHatchPath const &hatchPath, unsigned key);
 
+    /** Renders @a item alone into a bitmap of @a area in document coordinates,
+    at full opacity. Identical bitmaps are only kept once, so that they are only
+    embedded once in the output. The renderer owns the returned bitmap. */
+    Inkscape::Pixbuf *renderBitmap(SPItem *item, Geom::Rect const &area, unsigned width, unsigned height, double res);
+
+    /** Frees the bitmaps rendered so far. Call once the pages using them are
+    emitted; later bitmaps are no longer shared with the earlier ones. */
+    void releaseBitmaps();
+
 private:
     /** Extract metadata from doc and set it on ctx. */
     void setMetadata(CairoRenderContext *ctx, SPDocument *doc);
+
+    /** The area of the document shown on a page for @a base, in document coordinates. */
+    bool pageArea(SPDocument *doc, bool pageBoundingBox, float bleedmargin_px, SPItem *base, Geom::Rect &area);
+    /** Moves @a area to the origin of the page. */
+    void pageTransform(CairoRenderContext *ctx, Geom::Rect const &area, bool pageBoundingBox, float bleedmargin_px);
+
+    /** The document shown once for all bitmaps rendered by renderBitmap */
+    std::unique_ptr<Inkscape::ExportDrawing> _bitmap_drawing;
+    /** Bitmaps rendered so far, by a hash of their pixels */
+    std::multimap<std::uint64_t, std::unique_ptr<Inkscape::Pixbuf> > _bitmaps;
 };
 
 // FIXME: this should be a static method of CairoRenderer
@@ -72,7 +72,11 @@ SPDocument *open(Extension *key, gchar const *filename)
         gpointer parray[2];
         parray[0] = (gpointer)filename;
         parray[1] = (gpointer)&imod;
-        db.foreach(open_internal, (gpointer)&parray);
+        // Most files are opened by a module loaded at startup
+        db.foreach_loaded(open_internal, (gpointer)&parray);
+        if (imod == nullptr) {
+            db.foreach(open_internal, (gpointer)&parray);
+        }
     } else {
         imod = dynamic_cast<Input *>(key);
     }
@@ -448,6 +448,98 @@ pathv_matrix_point_bbox_wind_distance (Geom::PathVector const & pathv, Geom::Aff
     }
 }
 
+PathvPickIndex::PathvPickIndex(Geom::PathVector const &pathv, Geom::Affine const &m)
+    : _transform(m)
+{
+    // Split the path the same way as pathv_matrix_point_bbox_wind_distance()
+    for (const auto & it : pathv) {
+        Geom::Point p0 = it.initialPoint() * m;
+        Geom::Point const p_start = p0;
+        for (Geom::Path::const_iterator cit = it.begin(); cit != it.end_default(); ++cit) {
+            _addCurve(*cit, p0);
+        }
+        if (p0 != p_start) {
+            _segments.push_back({{p0, p_start}, false, true});
+        }
+    }
+
+    std::vector<Inkscape::Util::RTree<unsigned>::Entry> entries;
+    entries.reserve(_segments.size());
+    for (unsigned i = 0; i < _segments.size(); ++i) {
+        // the control points hull the curve
+        Segment const &segment = _segments[i];
+        Geom::Rect box(segment.p[0], segment.p[1]);
+        if (segment.cubic) {
+            box.expandTo(segment.p[2]);
+            box.expandTo(segment.p[3]);
+        }
+        _bounds.unionWith(box);
+        entries.emplace_back(box, i);
+    }
+    _index.build(std::move(entries));
+}
+
+void
+PathvPickIndex::_addCurve(Geom::Curve const &c, Geom::Point &p0)
+{
+    unsigned order = 0;
+    if (Geom::BezierCurve const* b = dynamic_cast<Geom::BezierCurve const*>(&c)) {
+        order = b->order();
+    }
+    if (order == 1) {
+        Geom::Point pe = c.finalPoint() * _transform;
+        _segments.push_back({{p0, pe}, false, false});
+        p0 = pe;
+    } else if (order == 3) {
+        Geom::CubicBezier const& cubic_bezier = static_cast<Geom::CubicBezier const&>(c);
+        Geom::Point p3 = cubic_bezier[3] * _transform;
+        _segments.push_back({{p0, cubic_bezier[1] * _transform, cubic_bezier[2] * _transform, p3}, true, false});
+        p0 = p3;
+    } else {
+        Geom::Path sbasis_path = Geom::cubicbezierpath_from_sbasis(c.toSBasis(), 0.1);
+        for (const auto & iter : sbasis_path) {
+            _addCurve(iter, p0);
+        }
+    }
+}
+
+void
+PathvPickIndex::windDistance(Geom::Point const &pt, int *wind, Geom::Coord *dist, Geom::Coord tolerance) const
+{
+    if (!_bounds) {
+        return;
+    }
+
+    auto measure = [&](Segment const &s, int *w, Geom::Coord *d) {
+        if (s.cubic) {
+            geom_cubic_bbox_wind_distance(s.p[0][X], s.p[0][Y], s.p[1][X], s.p[1][Y],
+                                          s.p[2][X], s.p[2][Y], s.p[3][X], s.p[3][Y],
+                                          pt, nullptr, w, d, tolerance);
+        } else {
+            geom_line_wind_distance(s.p[0][X], s.p[0][Y], s.p[1][X], s.p[1][Y], pt, w, d);
+        }
+    };
+
+    if (dist && *dist < Geom::infinity()) {
+        Geom::Rect area(pt, pt);
+        area.expandBy(*dist);
+        _index.search(area, [&](unsigned i) {
+            // as in pathv_matrix_point_bbox_wind_distance(), closing lines count when picking fill
+            if (wind || !_segments[i].closing) {
+                measure(_segments[i], nullptr, dist);
+            }
+        });
+    }
+
+    if (wind) {
+        // segments crossing the horizontal line to the left of the point
+        Geom::Rect ray(Geom::Point(std::min(_bounds->left(), pt[X]), pt[Y]), pt);
+        _index.search(ray, [&](unsigned i) {
+            measure(_segments[i], wind, nullptr);
+        });
+    }
+}
+
 //#################################################################################
 
 /*
@@ -15,10 +15,14 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <vector>
+
 #include <2geom/forward.h>
 #include <2geom/rect.h>
 #include <2geom/affine.h>
 
+#include "util/rtree.h"
+
 Geom::OptRect bounds_fast_transformed(Geom::PathVector const & pv, Geom::Affine const & t);
 Geom::OptRect bounds_exact_transformed(Geom::PathVector const & pv, Geom::Affine const & t);
 
@@ -26,6 +30,42 @@ void pathv_matrix_point_bbox_wind_distance ( Geom::PathVector const & pathv, Geo
                                              Geom::Rect *bbox, int *wind, Geom::Coord *dist,
                                              Geom::Coord tolerance, Geom::Rect const *viewbox);
 
+/**
+ * The curves of a path vector under a fixed transform, indexed by their bounding boxes, for
+ * answering many pathv_matrix_point_bbox_wind_distance() queries about the same path.
+ *
+ * Only the curves near the point, or crossing the horizontal line to the left of it for the
+ * winding number, are looked at.
+ */
+class PathvPickIndex {
+public:
+    PathvPickIndex(Geom::PathVector const &pathv, Geom::Affine const &m);
+
+    Geom::Affine const &transform() const { return _transform; }
+
+    /**
+     * Adds the winding number of the path around @a pt to *wind, and lowers *dist to the
+     * distance from @a pt to the path when that is smaller.
+     * Only curves within the initial *dist are measured, so it should be set to the largest
+     * distance of interest rather than to infinity.
+     */
+    void windDistance(Geom::Point const &pt, int *wind, Geom::Coord *dist, Geom::Coord tolerance) const;
+
+private:
+    struct Segment {
+        Geom::Point p[4];
+        bool cubic;
+        bool closing; ///< implicit closing line of a subpath, only part of the fill
+    };
+
+    void _addCurve(Geom::Curve const &c, Geom::Point &p0);
+
+    Geom::Affine _transform;
+    Geom::OptRect _bounds;
+    std::vector<Segment> _segments;
+    Inkscape::Util::RTree<unsigned> _index;
+};
+
 size_t count_pathvector_nodes(Geom::PathVector const &pathv );
 size_t count_path_nodes(Geom::Path const &path);
 Geom::PathVector pathv_to_linear_and_cubic_beziers( Geom::PathVector const &pathv );
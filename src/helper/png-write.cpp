@@ -15,6 +15,13 @@
  */
 
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <2geom/rect.h>
 #include <2geom/transforms.h>
 
@@ -123,10 +130,148 @@ void PngTextList::add(gchar const* key, gchar const* text)
     }
 }
 
+static int sp_export_render_rows(guchar **px, int *stride, int row, int num_rows, struct SPEBP *ebp, int antialiasing);
+static int sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, void *data, int color_type, int bit_depth, int antialiasing);
+
+/**
+ * Writes rows to a PNG being written on another thread than the one that set it up,
+ * with an error handler of its own.
+ */
+static bool
+sp_png_write_rows(png_structp png_ptr, png_bytepp rows, int num_rows)
+{
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        return false;
+    }
+    png_write_rows(png_ptr, rows, num_rows);
+    return true;
+}
+
+/**
+ * Converts and compresses rendered strips on a worker thread, in the order they are queued,
+ * so that rendering the next strips overlaps with writing the previous ones.
+ */
+class PngStripWriter {
+public:
+    PngStripWriter(png_structp png_ptr, unsigned long width, int color_type, int bit_depth, unsigned max_queued)
+        : _png_ptr(png_ptr)
+        , _width(width)
+        , _color_type(color_type)
+        , _bit_depth(bit_depth)
+        , _max_queued(max_queued)
+    {
+        _worker = std::thread([this] { _run(); });
+    }
+
+    ~PngStripWriter() { finish(); }
+
+    /**
+     * Queues a strip from sp_export_render_rows(), which the writer frees.
+     * Waits while the queue is full, bounding the memory used by the export.
+     * @return false if writing has failed, so that nothing more needs to be rendered
+     */
+    bool push(guchar *px, int stride, int num_rows)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _taken.wait(lock, [this] { return _strips.size() < _max_queued; });
+        _strips.push_back({px, stride, num_rows});
+        _queued.notify_one();
+        return !_failed;
+    }
+
+    /// Waits for the queued strips to be written; returns whether all of them were.
+    bool finish()
+    {
+        if (_worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _finished = true;
+            }
+            _queued.notify_one();
+            _worker.join();
+        }
+        return !_failed;
+    }
+
+private:
+    struct Strip {
+        guchar *px;
+        int stride;
+        int num_rows;
+    };
+
+    void _run()
+    {
+        std::vector<png_bytep> rows;
+        while (true) {
+            Strip strip;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _queued.wait(lock, [this] { return !_strips.empty() || _finished; });
+                if (_strips.empty()) {
+                    return;
+                }
+                strip = _strips.front();
+                _strips.pop_front();
+            }
+            _taken.notify_one();
+
+            if (!_failed) {
+                // PNG stores data as unpremultiplied big-endian RGBA, which means
+                // it's identical to the GdkPixbuf format.
+                convert_pixels_argb32_to_pixbuf(strip.px, _width, strip.num_rows, strip.stride);
+                rows.resize(strip.num_rows);
+                const guchar* new_data = pixbuf_to_png((guchar const **) rows.data(), strip.px, strip.num_rows,
+                                                       _width, strip.stride, _color_type, _bit_depth);
+                _failed = !sp_png_write_rows(_png_ptr, rows.data(), strip.num_rows);
+                free((void *) new_data);
+            }
+            g_free(strip.px);
+        }
+    }
+
+    png_structp _png_ptr;
+    unsigned long _width;
+    int _color_type;
+    int _bit_depth;
+    unsigned _max_queued;
+
+    std::thread _worker;
+    std::mutex _mutex;
+    std::condition_variable _queued;
+    std::condition_variable _taken;
+    std::deque<Strip> _strips;
+    bool _finished = false;
+    std::atomic<bool> _failed{false};
+};
+
+/**
+ * Renders the export strip by strip on this thread while a PngStripWriter writes them.
+ * @return false if writing failed
+ */
+static bool
+sp_png_write_strips_pipelined(png_structp png_ptr, struct SPEBP *ebp, int color_type, int bit_depth, int antialiasing)
+{
+    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+    unsigned const max_queued = prefs->getIntLimited("/options/exportstrips/value", 4, 1, 64);
+
+    PngStripWriter writer(png_ptr, ebp->width, color_type, bit_depth, max_queued);
+    unsigned long row = 0;
+    while (row < ebp->height) {
+        guchar *px;
+        int stride;
+        int n = sp_export_render_rows(&px, &stride, row, ebp->height - row, ebp, antialiasing);
+        if (!n || !writer.push(px, stride, n)) {
+            break;
+        }
+        row += n;
+    }
+    return writer.finish();
+}
+
 static bool
 sp_png_write_rgba_striped(SPDocument *doc,
                           gchar const *filename, unsigned long int width, unsigned long int height, double xdpi, double ydpi,
-                          int (* get_rows)(guchar const **rows, void **to_free, int row, int num_rows, void *data, int color_type, int bit_depth, int antialias),
                           void *data, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
 {
     g_return_val_if_fail(filename != nullptr, false);
@@ -282,22 +427,39 @@ sp_png_write_rgba_striped(SPDocument *doc,
      * use the first method if you aren't handling interlacing yourself.
      */
 
-    png_bytep* row_pointers = new png_bytep[ebp->sheight];
-    int number_of_passes = interlace ? png_set_interlace_handling(png_ptr) : 1;
-
-    for(int i=0;i<number_of_passes; ++i){
-        r = 0;
-        while (r < static_cast<png_uint_32>(height)) {
-            void *to_free;
-            int n = get_rows((unsigned char const **) row_pointers, &to_free, r, height-r, data, color_type, bit_depth, antialiasing);
-            if (!n) break;
-            png_write_rows(png_ptr, row_pointers, n);
-            g_free(to_free);
-            r += n;
+    if (interlace) {
+        // Each pass goes over all rows, so they are rendered again for each pass
+        png_bytep* row_pointers = new png_bytep[ebp->sheight];
+        int number_of_passes = png_set_interlace_handling(png_ptr);
+
+        for(int i=0;i<number_of_passes; ++i){
+            r = 0;
+            while (r < static_cast<png_uint_32>(height)) {
+                void *to_free;
+                int n = sp_export_get_rows((unsigned char const **) row_pointers, &to_free, r, height-r, data, color_type, bit_depth, antialiasing);
+                if (!n) break;
+                png_write_rows(png_ptr, row_pointers, n);
+                g_free(to_free);
+                r += n;
+            }
         }
-    }
 
-    delete[] row_pointers;
+        delete[] row_pointers;
+    } else {
+        bool written = sp_png_write_strips_pipelined(png_ptr, ebp, color_type, bit_depth, antialiasing);
+
+        // the worker thread had an error handler of its own
+        if (!written) {
+            fclose(fp);
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            return false;
+        }
+        if (setjmp(png_jmpbuf(png_ptr))) {
+            fclose(fp);
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            return false;
+        }
+    }
 
     /* You can write optional chunks like tEXt, zTXt, and tIME at the end
      * as well.
@@ -320,13 +482,12 @@ sp_png_write_rgba_striped(SPDocument *doc,
 
 
 /**
- *
+ * Renders up to num_rows rows from row into a new ARGB32 buffer, returned in *px.
+ * @return the number of rows rendered, 0 if the export was cancelled
  */
 static int
-sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, void *data, int color_type, int bit_depth, int antialiasing)
+sp_export_render_rows(guchar **px, int *stride, int row, int num_rows, struct SPEBP *ebp, int antialiasing)
 {
-    struct SPEBP *ebp = (struct SPEBP *) data;
-
     if (ebp->status) {
         if (!ebp->status((float) row / ebp->height, ebp->data)) return 0;
     }
@@ -343,11 +504,11 @@ sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, v
     /* Update to renderable state */
     ebp->drawing->update(bbox);
 
-    int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, ebp->width);
-    unsigned char *px = g_new(guchar, num_rows * stride);
+    *stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, ebp->width);
+    *px = g_new(guchar, num_rows * *stride);
 
     cairo_surface_t *s = cairo_image_surface_create_for_data(
-        px, CAIRO_FORMAT_ARGB32, ebp->width, num_rows, stride);
+        *px, CAIRO_FORMAT_ARGB32, ebp->width, num_rows, *stride);
     Inkscape::DrawingContext dc(s, bbox.min());
     dc.setSource(ebp->background);
     dc.setOperator(CAIRO_OPERATOR_SOURCE);
@@ -358,6 +519,22 @@ sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, v
     ebp->drawing->render(dc, bbox, 0, antialiasing);
     cairo_surface_destroy(s);
 
+    return num_rows;
+}
+
+/**
+ *
+ */
+static int
+sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, void *data, int color_type, int bit_depth, int antialiasing)
+{
+    struct SPEBP *ebp = (struct SPEBP *) data;
+
+    guchar *px;
+    int stride;
+    num_rows = sp_export_render_rows(&px, &stride, row, num_rows, ebp, antialiasing);
+    if (!num_rows) return 0;
+
     // PNG stores data as unpremultiplied big-endian RGBA, which means
     // it's identical to the GdkPixbuf format.
     convert_pixels_argb32_to_pixbuf(px, ebp->width, num_rows, stride);
@@ -365,33 +542,72 @@ sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, v
     // If a custom bit depth or color type is asked, then convert rgb to grayscale, etc.
     const guchar* new_data = pixbuf_to_png(rows, px, num_rows, ebp->width, stride, color_type, bit_depth);
     *to_free = (void*) new_data;
-    free(px);
+    g_free(px);
 
     return num_rows;
 }
 
+namespace Inkscape {
+
+ExportDrawing::ExportDrawing(SPDocument *doc)
+    : _doc(doc)
+    , _drawing(new Drawing())
+    , _dkey(SPItem::display_key_new(1))
+{
+    _doc->ensureUpToDate();
+    _drawing->setExact(true); // export with maximum blur rendering quality
+    _drawing->setRoot(_doc->getRoot()->invoke_show(*_drawing, _dkey, SP_ITEM_SHOW_DISPLAY));
+}
+
+ExportDrawing::~ExportDrawing()
+{
+    // Hide items, this releases arenaitem
+    _doc->getRoot()->invoke_hide(_dkey);
+}
+
+void ExportDrawing::showOnly(std::vector<SPItem*> const &items)
+{
+    for (auto item : _hidden) {
+        item->setVisible(true);
+    }
+    _hidden.clear();
+
+    // We show all and then hide all items we don't want, instead of showing only requested items,
+    // because that would not work if the shown item references something in defs
+    if (!items.empty()) {
+        _hideOthers(_doc->getRoot(), items);
+    }
+}
+
 /**
- * Hide all items that are not listed in list, recursively, skipping groups and defs.
+ * Hide all items that are not listed in items, recursively, skipping groups and defs.
  */
-static void hide_other_items_recursively(SPObject *o, const std::vector<SPItem*> &list, unsigned dkey)
+void ExportDrawing::_hideOthers(SPObject *o, std::vector<SPItem*> const &items)
 {
     if ( SP_IS_ITEM(o)
          && !SP_IS_DEFS(o)
          && !SP_IS_ROOT(o)
          && !SP_IS_GROUP(o)
-         && list.end()==find(list.begin(),list.end(),o))
+         && items.end()==find(items.begin(),items.end(),o))
     {
-        SP_ITEM(o)->invoke_hide(dkey);
+        DrawingItem *ai = SP_ITEM(o)->get_arenaitem(_dkey);
+        if (ai && ai->visible()) {
+            ai->setVisible(false);
+            _hidden.push_back(ai);
+        }
+        // everything below is hidden with it
+        return;
     }
 
     // recurse
-    if (list.end()==find(list.begin(),list.end(),o)) {
+    if (items.end()==find(items.begin(),items.end(),o)) {
         for (auto& child: o->children) {
-            hide_other_items_recursively(&child, list, dkey);
+            _hideOthers(&child, items);
         }
     }
 }
 
+} // namespace Inkscape
 
 ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
                                 double x0, double y0, double x1, double y1,
@@ -405,12 +621,33 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
                               width, height, xdpi, ydpi, bgcolor, status, data, force_overwrite, items_only, interlace, color_type, bit_depth, zlib, antialiasing);
 }
 
+ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
+                                Geom::Rect const &area,
+                                unsigned long width, unsigned long height, double xdpi, double ydpi,
+                                unsigned long bgcolor,
+                                unsigned (*status)(float, void *),
+                                void *data, bool force_overwrite,
+                                const std::vector<SPItem*> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
+{
+    g_return_val_if_fail(doc != nullptr, EXPORT_ERROR);
+    g_return_val_if_fail(filename != nullptr, EXPORT_ERROR);
+
+    if (!force_overwrite && !sp_ui_overwrite_file(filename)) {
+        // aborted overwrite
+	return EXPORT_ABORTED;
+    }
+
+    Inkscape::ExportDrawing drawing(doc);
+    return sp_export_png_file(drawing, filename, area, width, height, xdpi, ydpi, bgcolor, status, data, true,
+                              items_only, interlace, color_type, bit_depth, zlib, antialiasing);
+}
+
 /**
  * Export an area to a PNG file
  *
  * @param area Area in document coordinates
  */
-ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
+ExportResult sp_export_png_file(Inkscape::ExportDrawing &drawing, gchar const *filename,
                                 Geom::Rect const &area,
                                 unsigned long width, unsigned long height, double xdpi, double ydpi,
                                 unsigned long bgcolor,
@@ -418,7 +655,6 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
                                 void *data, bool force_overwrite,
                                 const std::vector<SPItem*> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
 {
-    g_return_val_if_fail(doc != nullptr, EXPORT_ERROR);
     g_return_val_if_fail(filename != nullptr, EXPORT_ERROR);
     g_return_val_if_fail(width >= 1, EXPORT_ERROR);
     g_return_val_if_fail(height >= 1, EXPORT_ERROR);
@@ -430,8 +666,6 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
 	return EXPORT_ABORTED;
     }
 
-    doc->ensureUpToDate();
-
     /* Calculate translation by transforming to document coordinates (flipping Y)*/
     Geom::Point translation = -area.min();
 
@@ -460,21 +694,11 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
     ebp.height = height;
     ebp.background = bgcolor;
 
-    /* Create new drawing */
-    Inkscape::Drawing drawing;
-    drawing.setExact(true); // export with maximum blur rendering quality
-    unsigned const dkey = SPItem::display_key_new(1);
+    // Set the transform of the shown document
+    drawing.drawing().root()->setTransform(affine);
+    ebp.drawing = &drawing.drawing();
 
-    // Create ArenaItems and set transform
-    drawing.setRoot(doc->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
-    drawing.root()->setTransform(affine);
-    ebp.drawing = &drawing;
-
-    // We show all and then hide all items we don't want, instead of showing only requested items,
-    // because that would not work if the shown item references something in defs
-    if (!items_only.empty()) {
-        hide_other_items_recursively(doc->getRoot(), items_only, dkey);
-    }
+    drawing.showOnly(items_only);
 
     ebp.status = status;
     ebp.data   = data;
@@ -485,13 +709,10 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
     ebp.px = g_try_new(guchar, 4 * ebp.sheight * width);
 
     if (ebp.px) {
-        write_status = sp_png_write_rgba_striped(doc, filename, width, height, xdpi, ydpi, sp_export_get_rows, &ebp, interlace, color_type, bit_depth, zlib, antialiasing);
+        write_status = sp_png_write_rgba_striped(drawing.document(), filename, width, height, xdpi, ydpi, &ebp, interlace, color_type, bit_depth, zlib, antialiasing);
         g_free(ebp.px);
     }
 
-    // Hide items, this releases arenaitem
-    doc->getRoot()->invoke_hide(dkey);
-
     return write_status ? EXPORT_OK : EXPORT_ERROR;
 }
 
@@ -17,10 +17,47 @@
 
 #include <glib.h> // Only for gchar.
 
+#include <memory>
+#include <vector>
+
 #include <2geom/forward.h>
 
 class SPDocument;
 class SPItem;
+class SPObject;
+
+namespace Inkscape {
+class Drawing;
+class DrawingItem;
+
+/**
+ * A document shown in a Drawing for PNG export.
+ *
+ * Exports of several objects or sizes from one document can share it
+ * instead of showing the whole document again for each file.
+ */
+class ExportDrawing {
+public:
+    ExportDrawing(SPDocument *doc);
+    ~ExportDrawing();
+
+    SPDocument *document() const { return _doc; }
+    Drawing &drawing() { return *_drawing; }
+    unsigned key() const { return _dkey; }
+
+    /// Shows only the given items and what they use, or the whole document if empty.
+    void showOnly(std::vector<SPItem*> const &items);
+
+private:
+    void _hideOthers(SPObject *o, std::vector<SPItem*> const &items);
+
+    SPDocument *_doc;
+    std::unique_ptr<Drawing> _drawing;
+    unsigned _dkey;
+    std::vector<DrawingItem *> _hidden;
+};
+
+} // namespace Inkscape
 
 enum ExportResult {
     EXPORT_ERROR = 0,
@@ -47,4 +84,14 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
 				unsigned int (*status) (float, void *), void *data, bool force_overwrite = false, const std::vector<SPItem*> &items_only = std::vector<SPItem*>(), 
                                 bool interlace = false, int color_type = 6, int bit_depth = 8, int zlib = 6, int antialiasing = 2);
 
+/**
+ * Export an area of a document already shown in @a drawing.
+ */
+ExportResult sp_export_png_file(Inkscape::ExportDrawing &drawing, gchar const *filename,
+                                Geom::Rect const &area,
+                                unsigned long int width, unsigned long int height, double xdpi, double ydpi,
+                                unsigned long bgcolor,
+                                unsigned int (*status) (float, void *), void *data, bool force_overwrite = false, const std::vector<SPItem*> &items_only = std::vector<SPItem*>(),
+                                bool interlace = false, int color_type = 6, int bit_depth = 8, int zlib = 6, int antialiasing = 2);
+
 #endif // SEEN_SP_PNG_WRITE_H
@@ -8,9 +8,12 @@
  *
  */
 
+#include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <iomanip>
 #include <regex>
+#include <streambuf>
 
 #include <glibmm/i18n.h>  // Internationalization
 
@@ -25,6 +28,9 @@
 #include "desktop.h"              // Access to window
 #include "file.h"                 // sp_file_convert_dpi
 #include "inkscape.h"             // Inkscape::Application
+#include "preferences.h"          // Shell document cache size
+
+#include "debug/startup-profile.h" // --startup-profile
 
 #include "include/glibmm_version.h"
 
@@ -68,6 +74,10 @@
 #include <readline/history.h>
 #endif
 
+#ifdef G_OS_UNIX
+#include <giomm/unixsocketaddress.h>
+#endif
+
 #include "io/resource.h"
 using Inkscape::IO::Resource::UIS;
 
@@ -116,10 +126,43 @@ InkscapeApplication::document_new(const std::string &Template)
 }
 
 
+// Key of a file in the document cache: its path and modification time. Empty if not cacheable.
+static std::string
+document_cache_key(const Glib::RefPtr<Gio::File>& file)
+{
+    std::string path = file->get_path();
+    if (path.empty()) {
+        return path;
+    }
+    try {
+        Glib::RefPtr<Gio::FileInfo> info =
+            file->query_info(G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+        return path + ":" + std::to_string(info->get_attribute_uint64(G_FILE_ATTRIBUTE_TIME_MODIFIED))
+                    + "." + std::to_string(info->get_attribute_uint32(G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC));
+    } catch (Glib::Error &) {
+        return std::string();
+    }
+}
+
 // Open a document, add it to app.
 SPDocument*
 InkscapeApplication::document_open(const Glib::RefPtr<Gio::File>& file)
 {
+    // Reuse an unchanged document closed earlier in shell mode.
+    std::string key;
+    if (_document_cache_size > 0) {
+        key = document_cache_key(file);
+        for (auto it = _document_cache.begin(); !key.empty() && it != _document_cache.end(); ++it) {
+            if (it->first == key) {
+                SPDocument *document = it->second;
+                _document_cache.erase(it);
+                _document_cache_keys[document] = key;
+                document_add (document);
+                return document;
+            }
+        }
+    }
+
     // Open file
     bool cancelled = false;
     SPDocument *document = ink_file_open(file, cancelled);
@@ -128,6 +171,9 @@ InkscapeApplication::document_open(const Glib::RefPtr<Gio::File>& file)
         document->setVirgin(false); // Prevents replacing document in same window during file open.
 
         document_add (document);
+        if (!key.empty()) {
+            _document_cache_keys[document] = key;
+        }
     } else {
         std::cerr << "InkscapeApplication::document_open: Failed to open: " << file->get_parse_name() << std::endl;
     }
@@ -282,6 +328,22 @@ InkscapeApplication::document_close(SPDocument* document)
             std::cerr << "InkscapeApplication::close_document: Document not registered with application." << std::endl;
         }
 
+        auto key = _document_cache_keys.find(document);
+        if (key != _document_cache_keys.end()) {
+            std::string cache_key = key->second;
+            _document_cache_keys.erase(key);
+
+            if (!document->isModifiedSinceSave()) {
+                // Keep it to be reopened, dropping the least recently used ones.
+                _document_cache.emplace_front(cache_key, document);
+                while (_document_cache.size() > _document_cache_size) {
+                    delete _document_cache.back().second;
+                    _document_cache.pop_back();
+                }
+                return;
+            }
+        }
+
         delete document;
 
     } else {
@@ -612,6 +674,7 @@ ConcreteInkscapeApplication<T>::ConcreteInkscapeApplication()
     this->add_main_option_entry(T::OPTION_TYPE_BOOL,     "export-plain-svg",       'l', N_("Remove Inkscape-specific SVG attributes/properties"),                       ""); // xSx
     this->add_main_option_entry(T::OPTION_TYPE_INT,      "export-ps-level",       '\0', N_("Postscript level (2 or 3); default is 3"),                         N_("LEVEL")); // xxP
     this->add_main_option_entry(T::OPTION_TYPE_STRING,   "export-pdf-version",    '\0', N_("PDF version (1.4 or 1.5); default is 1.5"),                      N_("VERSION")); // xxP
+    this->add_main_option_entry(T::OPTION_TYPE_BOOL,     "export-pdf-pages",      '\0', N_("Export each layer, or each object selected by export-id, as a page of one PDF file"), ""); // xxP
     this->add_main_option_entry(T::OPTION_TYPE_BOOL,     "export-text-to-path",    'T', N_("Convert text to paths (PS/EPS/PDF/SVG)"),                                   ""); // xxP
     this->add_main_option_entry(T::OPTION_TYPE_BOOL,     "export-latex",          '\0', N_("Export text separately to LaTeX file (PS/EPS/PDF)"),                        ""); // xxP
     this->add_main_option_entry(T::OPTION_TYPE_BOOL,     "export-ignore-filters", '\0', N_("Render objects without filters instead of rasterizing (PS/EPS/PDF)"),       ""); // xxP
@@ -649,6 +712,8 @@ ConcreteInkscapeApplication<T>::ConcreteInkscapeApplication()
     this->add_main_option_entry(T::OPTION_TYPE_BOOL,     "batch-process",         '\0', N_("Close GUI after executing all actions/verbs"),"");
     _start_main_option_section();
     this->add_main_option_entry(T::OPTION_TYPE_BOOL,     "shell",                 '\0', N_("Start Inkscape in interactive shell mode"),                                 "");
+    this->add_main_option_entry(T::OPTION_TYPE_STRING,   "shell-socket",          '\0', N_("Start Inkscape in shell mode, reading commands from a local socket"),  N_("PATH"));
+    this->add_main_option_entry(T::OPTION_TYPE_BOOL,     "startup-profile",       '\0', N_("Print the time taken by the stages of startup"),                           "");
 
 #ifdef WITH_DBUS
     _start_main_option_section(_("D-Bus"));
@@ -971,7 +1036,10 @@ template<class T>
 void
 ConcreteInkscapeApplication<T>::on_activate()
 {
-    on_startup2();
+    {
+        Inkscape::Debug::StartupStage stage("start application");
+        on_startup2();
+    }
 
     std::string output;
 
@@ -1000,7 +1068,12 @@ ConcreteInkscapeApplication<T>::on_activate()
     }
 
     // Process document (command line actions, shell, create window)
-    process_document (document, output);
+    {
+        Inkscape::Debug::StartupStage stage("process document");
+        process_document (document, output);
+    }
+
+    Inkscape::Debug::StartupStage::report();
 }
 
 // Open document window for each file. Either this or on_activate() is called.
@@ -1009,7 +1082,10 @@ template<class T>
 void
 ConcreteInkscapeApplication<T>::on_open(const Gio::Application::type_vec_files& files, const Glib::ustring& hint)
 {
-    on_startup2();
+    {
+        Inkscape::Debug::StartupStage stage("start application");
+        on_startup2();
+    }
     if(_pdf_poppler)
         INKSCAPE.set_pdf_poppler(_pdf_poppler);
     if(_pdf_page)
@@ -1027,16 +1103,23 @@ ConcreteInkscapeApplication<T>::on_open(const Gio::Application::type_vec_files&
     for (auto file : files) {
 
         // Open file
-        SPDocument *document = document_open (file);
+        SPDocument *document = nullptr;
+        {
+            Inkscape::Debug::StartupStage stage("open document");
+            document = document_open (file);
+        }
         if (!document) {
             std::cerr << "ConcreteInkscapeApplication::on_open: failed to create document!" << std::endl;
             continue;
         }
 
         // Process document (command line actions, shell, create window)
+        Inkscape::Debug::StartupStage stage("process document");
         process_document (document, file->get_path());
     }
 
+    Inkscape::Debug::StartupStage::report();
+
     if (_batch_process) {
         // If with_gui, we've reused a window for each file. We must quit to destroy it.
         Gio::Application::quit();
@@ -1165,6 +1248,14 @@ template<class T>
 void
 ConcreteInkscapeApplication<T>::shell()
 {
+    if (!_shell_socket.empty()) {
+        shell_socket();
+        if (_with_gui) {
+            Gio::Application::quit(); // Force closing windows.
+        }
+        return;
+    }
+
     std::cout << "Inkscape interactive shell mode. Type 'action-list' to list all actions. " 
               << "Type 'quit' to quit." << std::endl;
     std::cout << " Input of the form:" << std::endl;
@@ -1223,6 +1314,196 @@ ConcreteInkscapeApplication<T>::shell()
     }
 }
 
+#ifdef G_OS_UNIX
+namespace {
+
+/**
+ * While it exists, keeps a copy of what is written to std::cerr and of the messages logged
+ * as warnings or worse, which still reach their usual destination. Actions report failures
+ * this way, so the socket shell can pass them on to its client.
+ */
+class ShellErrorCapture : public std::streambuf {
+public:
+    ShellErrorCapture()
+        : _cerr(std::cerr.rdbuf(this))
+    {
+        _instance = this;
+        _log_func = g_log_set_default_handler(&ShellErrorCapture::log, nullptr);
+    }
+
+    ~ShellErrorCapture() override
+    {
+        g_log_set_default_handler(_log_func, nullptr);
+        _instance = nullptr;
+        std::cerr.rdbuf(_cerr);
+    }
+
+    /// The first line of what was captured, empty if there was nothing.
+    std::string firstLine() const
+    {
+        std::string::size_type start = _captured.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) {
+            return std::string();
+        }
+        return _captured.substr(start, _captured.find_first_of("\r\n", start) - start);
+    }
+
+protected:
+    int overflow(int c) override
+    {
+        if (c == traits_type::eof()) {
+            return traits_type::not_eof(c);
+        }
+        _captured.push_back(traits_type::to_char_type(c));
+        return _cerr->sputc(traits_type::to_char_type(c));
+    }
+
+    std::streamsize xsputn(char const *s, std::streamsize n) override
+    {
+        _captured.append(s, n);
+        return _cerr->sputn(s, n);
+    }
+
+    int sync() override { return _cerr->pubsync(); }
+
+private:
+    static void log(gchar const *domain, GLogLevelFlags level, gchar const *message, gpointer data)
+    {
+        if (_instance && (level & (G_LOG_LEVEL_ERROR | G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_WARNING))) {
+            _instance->_captured.append(message ? message : "");
+            _instance->_captured.push_back('\n');
+        }
+        GLogFunc next = _instance ? _instance->_log_func : g_log_default_handler;
+        next(domain, level, message, data);
+    }
+
+    static ShellErrorCapture *_instance;
+    std::streambuf *_cerr;
+    GLogFunc _log_func;
+    std::string _captured;
+};
+
+ShellErrorCapture *ShellErrorCapture::_instance = nullptr;
+
+}
+#endif
+
+/*
+ * Shell mode reading from a local socket, for serving many requests from one process.
+ *
+ * Clients are served one at a time, in the order they connect. Each line a client sends is
+ * handled like a line of the interactive shell and answered with a line giving its status
+ * and the time it took. The status is "error" with the first error message if the actions
+ * wrote to std::cerr or logged a warning. Unmodified documents closed with 'file-close' are kept in a cache
+ * and reused by 'file-open' as long as the file did not change.
+ */
+template<class T>
+void
+ConcreteInkscapeApplication<T>::shell_socket()
+{
+#ifdef G_OS_UNIX
+    Glib::RefPtr<Gio::Socket> socket;
+    try {
+        socket = Gio::Socket::create(Gio::SOCKET_FAMILY_UNIX, Gio::SOCKET_TYPE_STREAM, Gio::SOCKET_PROTOCOL_DEFAULT);
+        socket->bind(Gio::UnixSocketAddress::create(_shell_socket), false);
+        socket->listen();
+    } catch (Glib::Error &e) {
+        std::cerr << "InkscapeApplication::shell_socket: Cannot listen on " << _shell_socket
+                  << ": " << e.what() << std::endl;
+        return;
+    }
+    std::cout << "Inkscape shell mode listening on " << _shell_socket << ". "
+              << "Send 'quit' to quit." << std::endl;
+
+    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+    _document_cache_size = prefs->getIntLimited("/options/shell/documentcache/value", 16, 0, 1000);
+    // Seconds a client may stay silent before it is dropped, 0 to wait forever
+    int const timeout = prefs->getIntLimited("/options/shell/timeout/value", 60, 0, 86400);
+
+    bool quit = false;
+    while (!quit) {
+        Glib::RefPtr<Gio::Socket> client;
+        try {
+            client = socket->accept();
+        } catch (Glib::Error &e) {
+            std::cerr << "InkscapeApplication::shell_socket: " << e.what() << std::endl;
+            break;
+        }
+
+        std::string pending;
+        char buffer[4096];
+        try {
+            // A client that never sends a full line must not block the others
+            client->set_timeout(timeout);
+
+            gssize received = 0;
+            while (!quit && (received = client->receive(buffer, sizeof(buffer))) > 0) {
+                pending.append(buffer, received);
+
+                std::string::size_type end;
+                while (!quit && (end = pending.find('\n')) != std::string::npos) {
+                    std::string input = pending.substr(0, end);
+                    pending.erase(0, end + 1);
+
+                    // Remove trailing space
+                    input = std::regex_replace(input, std::regex("[ \r]+$"), "");
+
+                    if (input == "quit" || input == "q") {
+                        quit = true;
+                    } else if (!input.empty()) {
+                        auto start = std::chrono::steady_clock::now();
+                        std::string reply = "ok";
+                        {
+                            ShellErrorCapture errors;
+                            try {
+                                action_vector_t action_vector;
+                                parse_actions(input, action_vector);
+                                for (auto action: action_vector) {
+                                    Gio::Application::activate_action( action.first, action.second );
+                                }
+                            } catch (std::exception &e) {
+                                std::cerr << e.what() << std::endl;
+                            }
+
+                            Glib::RefPtr<Glib::MainContext> context = Glib::MainContext::get_default();
+                            while (context->iteration(false)) {};
+
+                            std::string error = errors.firstLine();
+                            if (!error.empty()) {
+                                reply = "error " + error;
+                            }
+                        }
+
+                        std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+                        reply += " " + std::to_string(time.count()) + "ms\n";
+                        client->send(reply.c_str(), reply.size());
+                    }
+                }
+            }
+        } catch (Glib::Error &e) {
+            std::cerr << "InkscapeApplication::shell_socket: " << e.what() << std::endl;
+        }
+        try {
+            client->close();
+        } catch (Glib::Error &e) {
+            std::cerr << "InkscapeApplication::shell_socket: " << e.what() << std::endl;
+        }
+    }
+
+    socket->close();
+    std::remove(_shell_socket.c_str());
+
+    // Documents still open are closed with the application, the cached ones only here.
+    for (auto &cached : _document_cache) {
+        delete cached.second;
+    }
+    _document_cache.clear();
+    _document_cache_size = 0;
+#else
+    std::cerr << "InkscapeApplication::shell_socket: Local sockets are not supported on this platform." << std::endl;
+#endif
+}
+
 
 // ========================= Callbacks ==========================
 
@@ -1243,6 +1524,10 @@ ConcreteInkscapeApplication<T>::on_handle_local_options(const Glib::RefPtr<Glib:
         return -1; // Keep going
     }
 
+    if (options->contains("startup-profile")) {
+        Inkscape::Debug::StartupStage::enable();
+    }
+
     // ===================== QUERY =====================
     // These are processed first as they result in immediate program termination.
     if (options->contains("version")) {
@@ -1298,6 +1583,7 @@ ConcreteInkscapeApplication<T>::on_handle_local_options(const Glib::RefPtr<Glib:
         options->contains("export-plain-svg")      ||
         options->contains("export-ps-level")       ||
         options->contains("export-pdf-version")    ||
+        options->contains("export-pdf-pages")      ||
         options->contains("export-text-to_path")   ||
         options->contains("export-latex")          ||
         options->contains("export-ignore-filters") ||
@@ -1317,7 +1603,8 @@ ConcreteInkscapeApplication<T>::on_handle_local_options(const Glib::RefPtr<Glib:
         options->contains("select")                ||
         options->contains("actions")               ||
         options->contains("verb")                  ||
-        options->contains("shell")
+        options->contains("shell")                 ||
+        options->contains("shell-socket")
         ) {
         _with_gui = false;
     }
@@ -1330,6 +1617,12 @@ ConcreteInkscapeApplication<T>::on_handle_local_options(const Glib::RefPtr<Glib:
 
     if (options->contains("batch-process"))  _batch_process = true;
     if (options->contains("shell"))          _use_shell = true;
+    if (options->contains("shell-socket")) {
+        Glib::ustring path;
+        options->lookup_value("shell-socket", path);
+        _shell_socket = path;
+        _use_shell = true;
+    }
     if (options->contains("pipe"))           _use_pipe  = true;
 
 
@@ -1475,6 +1768,7 @@ ConcreteInkscapeApplication<T>::on_handle_local_options(const Glib::RefPtr<Glib:
         options->lookup_value("export-pdf-version", _file_export.export_pdf_level);
     }
 
+    if (options->contains("export-pdf-pages"))    _file_export.export_pdf_pages   = true;
     if (options->contains("export-latex"))        _file_export.export_latex       = true;
     if (options->contains("export-use-hints"))    _file_export.export_use_hints   = true;
 
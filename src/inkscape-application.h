@@ -20,6 +20,8 @@
  *
  */
 
+#include <list>
+
 #include <gtkmm.h>
 
 #include "document.h"
@@ -112,12 +114,19 @@ protected:
     bool _auto_export = false;
     int _pdf_page     = 1;
     int _pdf_poppler  = false;
+    std::string _shell_socket; // Path of the socket to listen on in shell mode, if any.
     InkscapeApplication() = default;
 
     // Documents are owned by the application which is responsible for opening/saving/exporting. WIP
     // std::vector<SPDocument*> _documents;   For a true headless version
     std::map<SPDocument*, std::vector<InkscapeWindow*> > _documents;
 
+    // Unmodified documents closed in shell mode, kept to be reopened without reloading.
+    // Keyed by path and modification time, most recently closed first.
+    unsigned _document_cache_size = 0;
+    std::list<std::pair<std::string, SPDocument*> > _document_cache;
+    std::map<SPDocument*, std::string> _document_cache_keys; // Keys of open documents.
+
     // We keep track of these things so we don't need a window to find them (for headless operation).
     SPDocument*               _active_document   = nullptr;
     Inkscape::Selection*      _active_selection  = nullptr;
@@ -172,6 +181,7 @@ private:
     void on_about();
 
     void shell();
+    void shell_socket();
 
     void _start_main_option_section(const Glib::ustring& section_name = "");
 
@@ -40,6 +40,7 @@
 
 #include "debug/simple-event.h"
 #include "debug/event-tracker.h"
+#include "debug/startup-profile.h"
 
 #include "extension/db.h"
 #include "extension/init.h"
@@ -52,7 +53,6 @@
 #include "io/resource-manager.h"
 #include "io/sys.h"
 
-#include "libnrtype/FontFactory.h"
 
 #include "object/sp-root.h"
 #include "object/sp-style-elem.h"
@@ -272,23 +272,12 @@ Application::Application(bool use_gui) :
     }
 
     /* Initialize the extensions */
-    Inkscape::Extension::init();
-
-    /* Initialize font factory */
-    font_factory *factory = font_factory::Default();
-    if (prefs->getBool("/options/font/use_fontsdir_system", true)) {
-        char const *fontsdir = get_path(SYSTEM, FONTS);
-        factory->AddFontsDir(fontsdir);
-    }
-    if (prefs->getBool("/options/font/use_fontsdir_user", true)) {
-        char const *fontsdir = get_path(USER, FONTS);
-        factory->AddFontsDir(fontsdir);
-    }
-    Glib::ustring fontdirs_pref = prefs->getString("/options/font/custom_fontdirs");
-    std::vector<Glib::ustring> fontdirs = Glib::Regex::split_simple("\\|", fontdirs_pref);
-    for (auto &fontdir : fontdirs) {
-        factory->AddFontsDir(fontdir.c_str());
+    {
+        Inkscape::Debug::StartupStage stage("initialize extensions");
+        Inkscape::Extension::init();
     }
+
+    /* The font factory is initialized when text is first laid out */
 }
 
 Application::~Application()
@@ -52,6 +52,7 @@ InkFileExportCmd::InkFileExportCmd()
     , export_text_to_path(false)
     , export_ps_level(3)
     , export_pdf_level("1.5")
+    , export_pdf_pages(false)
     , export_latex(false)
     , export_id_only(false)
     , export_background_opacity(0.0) // Transparent default
@@ -216,6 +217,12 @@ InkFileExportCmd::get_filename_out(std::string filename_in, std::string object_i
 int
 InkFileExportCmd::do_export_svg(SPDocument* doc, std::string filename_in)
 {
+    // These options change the document without undo. Mark it modified so that shell mode
+    // does not reuse it as the unchanged file.
+    if (export_text_to_path || export_margin != 0 || export_area_drawing || !export_id.empty()) {
+        doc->setModifiedSinceSave();
+    }
+
     // Start with options that are once per document.
     if (export_text_to_path) {
         std::vector<SPItem*> items;
@@ -354,6 +361,9 @@ InkFileExportCmd::do_export_png(SPDocument *doc, std::string filename_in)
         objects.emplace_back(); // So we do loop at least once for root.
     }
 
+    // The document is shown once for all objects
+    std::unique_ptr<Inkscape::ExportDrawing> drawing;
+
     for (auto object_id : objects) {
 
         std::string filename_out = get_filename_out(filename_in, object_id);
@@ -548,7 +558,10 @@ InkFileExportCmd::do_export_png(SPDocument *doc, std::string filename_in)
 
         reverse(items.begin(),items.end()); // But there was only one item!
 
-        if( sp_export_png_file(doc, filename_out.c_str(), area, width, height, dpi,
+        if (!drawing) {
+            drawing.reset(new Inkscape::ExportDrawing(doc));
+        }
+        if( sp_export_png_file(*drawing, filename_out.c_str(), area, width, height, dpi,
                                dpi, bgcolor, nullptr, nullptr, true, export_id_only ? items : std::vector<SPItem*>()) == 1 ) {
         } else {
             std::cerr << "InkFileExport::do_export_png: Failed to export to " << filename_out << std::endl;
@@ -641,6 +654,9 @@ InkFileExportCmd::do_export_ps_pdf(SPDocument* doc, std::string filename_in, std
         if(set_export_pdf_version_fail) {
             (*i)->set_param_optiongroup(pdfver_param_name, "PDF-1.4");
         }
+
+        // handle --export-pdf-pages: without --export-id, each layer is a page
+        (*i)->set_param_bool("layersAsPages", export_pdf_pages && export_id.empty());
     }
 
     if (mime_type == "image/x-postscript" || mime_type == "image/x-e-postscript") {
@@ -660,15 +676,29 @@ InkFileExportCmd::do_export_ps_pdf(SPDocument* doc, std::string filename_in, std
         objects.emplace_back(); // So we do loop at least once for root.
     }
 
+    // With --export-pdf-pages, the objects are the pages of a single file, named after the input.
+    bool const object_pages = export_pdf_pages && mime_type == "application/pdf" && objects.size() > 1;
+    if (object_pages) {
+        for (auto const &object : objects) {
+            if (doc->getObjectById(object) == nullptr) {
+                std::cerr << "InkFileExportCmd::do_export_ps_pdf: Object " << object << " not found in document, nothing to export." << std::endl;
+                return 1;
+            }
+        }
+        objects.assign(1, export_id);
+    }
+
     for (auto object : objects) {
 
-        std::string filename_out = get_filename_out(filename_in, object);
+        std::string filename_out = get_filename_out(filename_in, object_pages ? "" : object);
         if (filename_out.empty()) {
             return 1;
         }
 
         // Export only object with given id.
-        if (!object.empty()) {
+        if (object_pages) {
+            (*i)->set_param_string ("exportId", object.c_str());
+        } else if (!object.empty()) {
             SPObject *o = doc->getObjectById(object);
             if (o == nullptr) {
                 std::cerr << "InkFileExportCmd::do_export_ps_pdf: Object " << object << " not found in document, nothing to export." << std::endl;
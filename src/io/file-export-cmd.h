@@ -56,6 +56,7 @@ public:
     bool          export_text_to_path;
     int           export_ps_level;
     Glib::ustring export_pdf_level;
+    bool          export_pdf_pages;
     bool          export_latex;
     Glib::ustring export_id;
     bool          export_id_only;
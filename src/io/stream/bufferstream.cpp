@@ -133,6 +133,17 @@ int BufferOutputStream::put(char ch)
     return 1;
 }
 
+/**
+ * Writes a block of bytes to this output stream.
+ */
+int BufferOutputStream::write(char const *buf, size_t len)
+{
+    if (closed)
+        return -1;
+    buffer.insert(buffer.end(), buf, buf + len);
+    return len;
+}
+
 
 
 
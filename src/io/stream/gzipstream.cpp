@@ -17,6 +17,7 @@
  */
 
 #include "gzipstream.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -289,6 +290,11 @@ int GzipInputStream::fetchMore()
 //# G Z I P   O U T P U T    S T R E A M
 //#########################################################################
 
+/// Uncompressed bytes collected before they are handed to deflate
+#define DEFLATE_IN_SIZE  65536
+/// Size of the chunks deflate output is written out in
+#define DEFLATE_OUT_SIZE 16384
+
 /**
  *
  */ 
@@ -324,6 +330,14 @@ GzipOutputStream::GzipOutputStream(OutputStream &destinationStream)
     //apparently, we should not explicitly include zutil.h
     destination.put(0);
 
+    inputBuf.reserve(DEFLATE_IN_SIZE);
+
+    // Raw deflate (negative window bits): the gzip header and trailer are written by hand
+    memset(&d_stream, 0, sizeof(d_stream));
+    int zerr = deflateInit2(&d_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (zerr != Z_OK) {
+        printf("Some kind of problem\n");
+    }
 }
 
 /**
@@ -343,7 +357,8 @@ void GzipOutputStream::close()
     if (closed)
         return;
 
-    flush();
+    deflateBuffer(Z_FINISH);
+    deflateEnd(&d_stream);
 
     //# Send the CRC
     uLong outlong = crc;
@@ -370,51 +385,45 @@ void GzipOutputStream::close()
  */ 
 void GzipOutputStream::flush()
 {
-    if (closed || inputBuf.empty())
-	{
-        return;
-    }
-	
-    uLong srclen = inputBuf.size();
-    Bytef *srcbuf = new (std::nothrow) Bytef [srclen];
-    if (!srcbuf)
-        {
+    if (closed)
         return;
-        }
-        
-    uLong destlen = srclen;
-    Bytef *destbuf = new (std::nothrow) Bytef [(destlen + (srclen/100) + 13)];
-    if (!destbuf)
-        {
-        delete[] srcbuf;
+
+    deflateBuffer(Z_SYNC_FLUSH);
+    destination.flush();
+}
+
+/**
+ * Runs the buffered input through deflate and writes the compressed
+ * result to the destination.  Only Z_FINISH ends the deflate stream,
+ * so repeated flushes keep producing a single valid gzip member.
+ */
+void GzipOutputStream::deflateBuffer(int zflush)
+{
+    if (inputBuf.empty() && zflush == Z_NO_FLUSH)
         return;
-        }
-        
-    std::vector<unsigned char>::iterator iter;
-    Bytef *p = srcbuf;
-    for (iter=inputBuf.begin() ; iter != inputBuf.end() ; ++iter)
-        *p++ = *iter;
-        
-    crc = crc32(crc, const_cast<const Bytef *>(srcbuf), srclen);
-    
-    int zerr = compress(destbuf, static_cast<uLongf *>(&destlen), srcbuf, srclen);
-    if (zerr != Z_OK)
-        {
-        printf("Some kind of problem\n");
-        }
 
-    totalOut += destlen;
-    //skip the redundant zlib header and checksum
-    for (uLong i=2; i<destlen-4 ; i++)
-        {
-        destination.put((int)destbuf[i]);
+    crc = crc32(crc, inputBuf.data(), inputBuf.size());
+
+    d_stream.next_in  = inputBuf.data();
+    d_stream.avail_in = inputBuf.size();
+
+    Bytef outbuf[DEFLATE_OUT_SIZE];
+    do {
+        d_stream.next_out  = outbuf;
+        d_stream.avail_out = DEFLATE_OUT_SIZE;
+        int zerr = deflate(&d_stream, zflush);
+        if (zerr == Z_STREAM_ERROR) {
+            printf("Some kind of problem\n");
+            break;
         }
-        
-    destination.flush();
+        size_t have = DEFLATE_OUT_SIZE - d_stream.avail_out;
+        if (have) {
+            destination.write(reinterpret_cast<char const *>(outbuf), have);
+            totalOut += have;
+        }
+    } while (d_stream.avail_out == 0);
 
     inputBuf.clear();
-    delete[] srcbuf;
-    delete[] destbuf;
 }
 
 
@@ -434,9 +443,32 @@ int GzipOutputStream::put(char ch)
     //Add char to buffer
     inputBuf.push_back(ch);
     totalIn++;
+    if (inputBuf.size() >= DEFLATE_IN_SIZE)
+        deflateBuffer(Z_NO_FLUSH);
     return 1;
 }
 
+/**
+ * Writes a block of bytes to this output stream.
+ */
+int GzipOutputStream::write(char const *buf, size_t len)
+{
+    if (closed)
+        return -1;
+
+    size_t left = len;
+    while (left > 0) {
+        size_t n = std::min(left, DEFLATE_IN_SIZE - inputBuf.size());
+        inputBuf.insert(inputBuf.end(), buf, buf + n);
+        buf += n;
+        left -= n;
+        if (inputBuf.size() >= DEFLATE_IN_SIZE)
+            deflateBuffer(Z_NO_FLUSH);
+    }
+    totalIn += len;
+    return len;
+}
+
 
 
 } // namespace IO
@@ -101,14 +101,20 @@ public:
     
     int put(char ch) override;
 
+    int write(char const *buf, size_t len) override;
+
 private:
 
+    void deflateBuffer(int zflush);
+
     std::vector<unsigned char> inputBuf;
 
     long totalIn;
     long totalOut;
     unsigned long crc;
 
+    z_stream d_stream;
+
 }; // class GzipOutputStream
 
 
@@ -13,6 +13,7 @@
  */
 
 #include <cstdlib>
+#include <cstring>
 #include "inkscapestream.h"
 
 namespace Inkscape
@@ -87,6 +88,25 @@ int BasicInputStream::get()
    
 
 
+//#########################################################################
+//# O U T P U T    S T R E A M
+//#########################################################################
+
+/**
+ * Writes a block of bytes to this output stream, one at a time.
+ */
+int OutputStream::write(char const *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (put(buf[i]) < 0) {
+            return -1;
+        }
+    }
+    return len;
+}
+
+
+
 //#########################################################################
 //# B A S I C    O U T P U T    S T R E A M
 //#########################################################################
@@ -493,6 +513,17 @@ Writer &BasicWriter::writeChar(char ch)
     return *this;
 }
 
+/**
+ * Writes a block of characters to this output writer.
+ */ 
+Writer &BasicWriter::write(char const *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        put(buf[i]);
+    }
+    return *this;
+}
+
 
 /**
  * Writes the specified unicode string to this output writer.
@@ -508,10 +539,7 @@ Writer &BasicWriter::writeUString(const Glib::ustring &str)
  */ 
 Writer &BasicWriter::writeStdString(const std::string &str)
 {
-    for (char it : str) {
-        put(it);
-    }
-    return *this;
+    return write(str.data(), str.size());
 }
 
 /**
@@ -519,13 +547,9 @@ Writer &BasicWriter::writeStdString(const std::string &str)
  */ 
 Writer &BasicWriter::writeString(const char *str)
 {
-    std::string tmp;
-    if (str)
-        tmp = str;
-    else
-        tmp = "null";
-    writeStdString(tmp);
-    return *this;
+    if (!str)
+        str = "null";
+    return write(str, strlen(str));
 }
 
 
@@ -740,6 +764,15 @@ void OutputStreamWriter::put(char ch)
     outputStream.put(ch);
 }
 
+/**
+ *  Hands blocks of chars to the OutputStream in one go.
+ */
+Writer &OutputStreamWriter::write(char const *buf, size_t len)
+{
+    outputStream.write(buf, len);
+    return *this;
+}
+
 //#########################################################################
 //# S T D    W R I T E R
 //#########################################################################
@@ -192,6 +192,13 @@ public:
      */
     virtual int put(char ch) = 0;
 
+    /**
+     * Send a block of bytes to the destination stream.  The default
+     * calls put() for each byte; endpoints override it to avoid the
+     * per-byte overhead.
+     */
+    virtual int write(char const *buf, size_t len);
+
 
 }; // class OutputStream
 
@@ -478,6 +485,8 @@ public:
 
     virtual Writer& writeChar(char val) = 0;
 
+    virtual Writer& write(char const *buf, size_t len) = 0;
+
     virtual Writer& writeUString(const Glib::ustring &val) = 0;
 
     virtual Writer& writeStdString(const std::string &val) = 0;
@@ -534,6 +543,8 @@ public:
 
     Writer& writeChar(char val) override;
 
+    Writer& write(char const *buf, size_t len) override;
+
     Writer& writeUString(const Glib::ustring &val) override;
 
     Writer& writeStdString(const std::string &val) override;
@@ -618,6 +629,8 @@ public:
     
     void put(char ch) override;
 
+    Writer& write(char const *buf, size_t len) override;
+
 
 private:
 
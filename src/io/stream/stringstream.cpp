@@ -115,6 +115,16 @@ int StringOutputStream::put(char ch)
 	return 1;
 }
 
+/**
+ * Writes a block of bytes to this output stream.
+ */
+int StringOutputStream::write(char const *buf, size_t len)
+{
+    // the iterator overload appends bytes, not characters
+    buffer.append(buf, buf + len);
+    return len;
+}
+
 
 } // namespace IO
 } // namespace Inkscape
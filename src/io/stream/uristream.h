@@ -80,6 +80,8 @@ public:
 
     int put(char ch) override;
 
+    int write(char const *buf, size_t len) override;
+
 private:
 
     bool ownsFile;
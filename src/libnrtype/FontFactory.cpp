@@ -21,6 +21,7 @@
 #include <unordered_map>
 
 #include <glibmm/i18n.h>
+#include <glibmm/regex.h>
 
 #include <fontconfig/fontconfig.h>
 
@@ -28,12 +29,16 @@
 #include <pango/pangoft2.h>
 #include <pango/pango-ot.h>
 
+#include "io/resource.h"
 #include "io/sys.h"
 
 #include "libnrtype/FontFactory.h"
 #include "libnrtype/font-instance.h"
 #include "libnrtype/OpenTypeUtil.h"
 
+#include "debug/startup-profile.h"
+#include "preferences.h"
+
 typedef std::unordered_map<PangoFontDescription*, font_instance*, font_descr_hash, font_descr_equal> FaceMapType;
 
 // need to avoid using the size field
@@ -234,7 +239,12 @@ font_factory *font_factory::lUsine = nullptr;
 
 font_factory *font_factory::Default()
 {
-    if ( lUsine == nullptr ) lUsine = new font_factory;
+    if ( lUsine == nullptr ) {
+        // Set up on first use rather than at startup, as many documents have no text.
+        Inkscape::Debug::StartupStage stage("load fonts");
+        lUsine = new font_factory;
+        lUsine->AddFontsDirs();
+    }
     return lUsine;
 }
 
@@ -779,6 +789,26 @@ void font_factory::AddInCache(font_instance *who)
     nbEnt++;
 }
 
+void font_factory::AddFontsDirs()
+{
+    using namespace Inkscape::IO::Resource;
+
+    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+    if (prefs->getBool("/options/font/use_fontsdir_system", true)) {
+        char const *fontsdir = get_path(SYSTEM, FONTS);
+        AddFontsDir(fontsdir);
+    }
+    if (prefs->getBool("/options/font/use_fontsdir_user", true)) {
+        char const *fontsdir = get_path(USER, FONTS);
+        AddFontsDir(fontsdir);
+    }
+    Glib::ustring fontdirs_pref = prefs->getString("/options/font/custom_fontdirs");
+    std::vector<Glib::ustring> fontdirs = Glib::Regex::split_simple("\\|", fontdirs_pref);
+    for (auto &fontdir : fontdirs) {
+        AddFontsDir(fontdir.c_str());
+    }
+}
+
 void font_factory::AddFontsDir(char const *utf8dir)
 {
 #ifdef USE_PANGO_WIN32
@@ -148,6 +148,9 @@ public:
     /// Add a directory from which to include additional fonts
     void                  AddFontsDir(char const *utf8dir);
 
+    /// Adds the font directories set in the preferences.
+    void                  AddFontsDirs();
+
     /// Add a an additional font.
     void                  AddFontFile(char const *utf8file);
 
@@ -13,6 +13,8 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+
 #include <2geom/circle.h>
 #include <2geom/line.h>
 #include <2geom/path-intersection.h>
@@ -40,12 +42,15 @@
 
 #include "svg/svg.h"
 
+#include "util/rtree.h"
+
 Inkscape::ObjectSnapper::ObjectSnapper(SnapManager *sm, Geom::Coord const d)
     : Snapper(sm, d)
 {
     _candidates = new std::vector<SnapCandidateItem>;
     _points_to_snap_to = new std::vector<SnapCandidatePoint>;
     _paths_to_snap_to = new std::vector<SnapCandidatePath >;
+    _points_index = new Util::RTree<unsigned>;
 }
 
 Inkscape::ObjectSnapper::~ObjectSnapper()
@@ -55,6 +60,7 @@ Inkscape::ObjectSnapper::~ObjectSnapper()
 
     _points_to_snap_to->clear();
     delete _points_to_snap_to;
+    delete _points_index;
 
     _clear_paths();
     delete _paths_to_snap_to;
@@ -72,95 +78,164 @@ bool Inkscape::ObjectSnapper::getSnapperAlwaysSnap() const
     return _snapmanager->snapprefs.getObjectTolerance() == 10000; //TODO: Replace this threshold of 10000 by a constant; see also tolerance-slider.cpp
 }
 
-void Inkscape::ObjectSnapper::_findCandidates(SPObject* parent,
-                                              std::vector<SPItem const *> const *it,
-                                              bool const &first_point,
-                                              Geom::Rect const &bbox_to_snap,
-                                              bool const clip_or_mask,
-                                              Geom::Affine const additional_affine) const // transformation of the item being clipped / masked
+void Inkscape::ObjectSnapper::_findCandidates(std::vector<SPItem const *> const *it,
+                                              Geom::Rect const &bbox_to_snap) const
 {
+    _candidates->clear();
+
     SPDesktop const *dt = _snapmanager->getDesktop();
     if (dt == nullptr) {
         g_warning("desktop == NULL, so we cannot snap; please inform the developers of this bug");
         // Apparently the setup() method from the SnapManager class hasn't been called before trying to snap.
+        return;
     }
 
-    if (first_point) {
-        _candidates->clear();
+    std::unordered_set<SPItem const *> ignore;
+    if (it != nullptr) {
+        ignore.insert(it->begin(), it->end());
     }
 
     Geom::Rect bbox_to_snap_incl = bbox_to_snap; // _incl means: will include the snapper tolerance
     bbox_to_snap_incl.expandBy(getSnapperTolerance()); // see?
 
+    SPDocument *doc = _snapmanager->getDocument();
+    SPRoot *root = doc->getRoot();
+    if (_snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_ROTATION_CENTER)) {
+        // The rotation center might be far outside of the bounding box, so the spatial index of the document won't find it
+        _findCandidatesInTree(root, ignore, bbox_to_snap_incl, false, Geom::identity());
+        return;
+    }
+
+    // Only look at the items whose visual bounding box is in range; the geometric one is contained in it
+    std::vector<SPItem*> items = doc->getItemsPartiallyInBox(dt->dkey, bbox_to_snap_incl * dt->dt2doc(), true, true, false, true);
+    std::unordered_set<SPItem const *> groups_done;
+    for (auto item : items) {
+        // Skip the items that are hidden or ignored, or in such a group
+        std::vector<SPItem *> ancestors;
+        bool skip = false;
+        for (SPObject *o = item; o && o != root; o = o->parent) {
+            SPItem *ancestor = dynamic_cast<SPItem *>(o);
+            if (!ancestor || dt->itemIsHidden(ancestor) || ignore.count(ancestor)) {
+                skip = true;
+                break;
+            }
+            ancestors.push_back(ancestor);
+        }
+        if (skip) {
+            continue;
+        }
+
+        // Groups can be clipped and masked too; visit them from the top down, once
+        for (auto i = ancestors.rbegin(); i != ancestors.rend(); ++i) {
+            if (*i != item && !groups_done.insert(*i).second) {
+                continue;
+            }
+            if (!_findClipAndMaskCandidates(*i, ignore, bbox_to_snap_incl)) {
+                return;
+            }
+        }
+        if (!_addCandidate(item, bbox_to_snap_incl, false, Geom::identity())) {
+            return;
+        }
+    }
+}
+
+bool Inkscape::ObjectSnapper::_findCandidatesInTree(SPObject* parent,
+                                                    std::unordered_set<SPItem const *> const &ignore,
+                                                    Geom::Rect const &bbox_to_snap_incl,
+                                                    bool const clip_or_mask,
+                                                    Geom::Affine const additional_affine) const // transformation of the item being clipped / masked
+{
+    SPDesktop const *dt = _snapmanager->getDesktop();
+
     for (auto& o: parent->children) {
-        g_assert(dt != nullptr);
         SPItem *item = dynamic_cast<SPItem *>(&o);
         if (item && !(dt->itemIsHidden(item) && !clip_or_mask)) {
             // Snapping to items in a locked layer is allowed
             // Don't snap to hidden objects, unless they're a clipped path or a mask
             /* See if this item is on the ignore list */
-            std::vector<SPItem const *>::const_iterator i;
-            if (it != nullptr) {
-                i = it->begin();
-                while (i != it->end() && *i != &o) {
-                    ++i;
-                }
+            if (ignore.count(item)) {
+                continue;
             }
 
-            if (it == nullptr || i == it->end()) {
-                if (item) {
-                    if (!clip_or_mask) { // cannot clip or mask more than once
-                        // The current item is not a clipping path or a mask, but might
-                        // still be the subject of clipping or masking itself ; if so, then
-                        // we should also consider that path or mask for snapping to
-                        SPObject *obj = item->getClipObject();
-                        if (obj && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_PATH_CLIP)) {
-                            _findCandidates(obj, it, false, bbox_to_snap, true, item->i2doc_affine());
-                        }
-                        obj = item->getMaskObject();
-                        if (obj && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_PATH_MASK)) {
-                            _findCandidates(obj, it, false, bbox_to_snap, true, item->i2doc_affine());
-                        }
-                    }
+            if (!clip_or_mask) { // cannot clip or mask more than once
+                // The current item is not a clipping path or a mask, but might
+                // still be the subject of clipping or masking itself ; if so, then
+                // we should also consider that path or mask for snapping to
+                if (!_findClipAndMaskCandidates(item, ignore, bbox_to_snap_incl)) {
+                    return false;
+                }
+            }
 
-                    if (dynamic_cast<SPGroup *>(item)) {
-                        _findCandidates(&o, it, false, bbox_to_snap, clip_or_mask, additional_affine);
-                    } else {
-                        Geom::OptRect bbox_of_item;
-                        Preferences *prefs = Preferences::get();
-                        int prefs_bbox = prefs->getBool("/tools/bounding_box", false);
-                        // We'll only need to obtain the visual bounding box if the user preferences tell
-                        // us to, AND if we are snapping to the bounding box itself. If we're snapping to
-                        // paths only, then we can just as well use the geometric bounding box (which is faster)
-                        SPItem::BBoxType bbox_type = (!prefs_bbox && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_BBOX_CATEGORY)) ?
-                            SPItem::VISUAL_BBOX : SPItem::GEOMETRIC_BBOX;
-                        if (clip_or_mask) {
-                            // Oh oh, this will get ugly. We cannot use sp_item_i2d_affine directly because we need to
-                            // insert an additional transformation in document coordinates (code copied from sp_item_i2d_affine)
-                            bbox_of_item = item->bounds(bbox_type, item->i2doc_affine() * additional_affine * dt->doc2dt());
-                        } else {
-                            bbox_of_item = item->desktopBounds(bbox_type);
-                        }
-                        if (bbox_of_item) {
-                            // See if the item is within range
-                            if (bbox_to_snap_incl.intersects(*bbox_of_item)
-                                    || (_snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_ROTATION_CENTER) && bbox_to_snap_incl.contains(item->getCenter()))) { // rotation center might be outside of the bounding box
-                                // This item is within snapping range, so record it as a candidate
-                                _candidates->push_back(SnapCandidateItem(item, clip_or_mask, additional_affine));
-                                // For debugging: print the id of the candidate to the console
-                                // SPObject *obj = (SPObject*)item;
-                                // std::cout << "Snap candidate added: " << obj->getId() << std::endl;
-                                if (_candidates->size() > 200) { // This makes Inkscape crawl already
-                                    std::cout << "Warning: limit of 200 snap target paths reached, some will be ignored" << std::endl;
-                                    break;
-                                }
-                            }
-                        }
-                    }
+            if (dynamic_cast<SPGroup *>(item)) {
+                if (!_findCandidatesInTree(&o, ignore, bbox_to_snap_incl, clip_or_mask, additional_affine)) {
+                    return false;
                 }
+            } else if (!_addCandidate(item, bbox_to_snap_incl, clip_or_mask, additional_affine)) {
+                return false;
             }
         }
     }
+    return true;
+}
+
+bool Inkscape::ObjectSnapper::_findClipAndMaskCandidates(SPItem *item,
+                                                         std::unordered_set<SPItem const *> const &ignore,
+                                                         Geom::Rect const &bbox_to_snap_incl) const
+{
+    SPObject *obj = item->getClipObject();
+    if (obj && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_PATH_CLIP)) {
+        if (!_findCandidatesInTree(obj, ignore, bbox_to_snap_incl, true, item->i2doc_affine())) {
+            return false;
+        }
+    }
+    obj = item->getMaskObject();
+    if (obj && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_PATH_MASK)) {
+        if (!_findCandidatesInTree(obj, ignore, bbox_to_snap_incl, true, item->i2doc_affine())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Inkscape::ObjectSnapper::_addCandidate(SPItem *item,
+                                           Geom::Rect const &bbox_to_snap_incl,
+                                           bool const clip_or_mask,
+                                           Geom::Affine const &additional_affine) const
+{
+    SPDesktop const *dt = _snapmanager->getDesktop();
+
+    Geom::OptRect bbox_of_item;
+    Preferences *prefs = Preferences::get();
+    int prefs_bbox = prefs->getBool("/tools/bounding_box", false);
+    // We'll only need to obtain the visual bounding box if the user preferences tell
+    // us to, AND if we are snapping to the bounding box itself. If we're snapping to
+    // paths only, then we can just as well use the geometric bounding box (which is faster)
+    SPItem::BBoxType bbox_type = (!prefs_bbox && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_BBOX_CATEGORY)) ?
+        SPItem::VISUAL_BBOX : SPItem::GEOMETRIC_BBOX;
+    if (clip_or_mask) {
+        // Oh oh, this will get ugly. We cannot use sp_item_i2d_affine directly because we need to
+        // insert an additional transformation in document coordinates (code copied from sp_item_i2d_affine)
+        bbox_of_item = item->bounds(bbox_type, item->i2doc_affine() * additional_affine * dt->doc2dt());
+    } else {
+        bbox_of_item = item->desktopBounds(bbox_type);
+    }
+    if (bbox_of_item) {
+        // See if the item is within range
+        if (bbox_to_snap_incl.intersects(*bbox_of_item)
+                || (_snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_ROTATION_CENTER) && bbox_to_snap_incl.contains(item->getCenter()))) { // rotation center might be outside of the bounding box
+            // This item is within snapping range, so record it as a candidate
+            _candidates->push_back(SnapCandidateItem(item, clip_or_mask, additional_affine));
+            // For debugging: print the id of the candidate to the console
+            // SPObject *obj = (SPObject*)item;
+            // std::cout << "Snap candidate added: " << obj->getId() << std::endl;
+            if (_candidates->size() > 200) { // This makes Inkscape crawl already
+                std::cout << "Warning: limit of 200 snap target paths reached, some will be ignored" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 
@@ -172,6 +247,7 @@ void Inkscape::ObjectSnapper::_collectNodes(SnapSourceType const &t,
     // first point and store the collection for later use. This significantly improves the performance
     if (first_point) {
         _points_to_snap_to->clear();
+        _points_index->clear();
 
          // Determine the type of bounding box we should snap to
         SPItem::BBoxType bbox_type = SPItem::GEOMETRIC_BBOX;
@@ -270,6 +346,14 @@ void Inkscape::ObjectSnapper::_collectNodes(SnapSourceType const &t,
                 }
             }
         }
+
+        std::vector<Util::RTree<unsigned>::Entry> entries;
+        entries.reserve(_points_to_snap_to->size());
+        for (unsigned i = 0; i < _points_to_snap_to->size(); ++i) {
+            Geom::Point const target_pt = (*_points_to_snap_to)[i].getPoint();
+            entries.emplace_back(Geom::Rect(target_pt, target_pt), i);
+        }
+        _points_index->build(std::move(entries));
     }
 }
 
@@ -279,22 +363,18 @@ void Inkscape::ObjectSnapper::_snapNodes(IntermSnapResults &isr,
                                          SnapConstraint const &c,
                                          Geom::Point const &p_proj_on_constraint) const
 {
-    // Iterate through all nodes, find out which one is the closest to p, and snap to it!
+    // Find out which of the nodes close to p is the closest one, and snap to it!
 
     _collectNodes(p.getSourceType(), p.getSourceNum() <= 0);
 
-    if (unselected_nodes != nullptr && unselected_nodes->size() > 0) {
-        g_assert(_points_to_snap_to != nullptr);
-        _points_to_snap_to->insert(_points_to_snap_to->end(), unselected_nodes->begin(), unselected_nodes->end());
-    }
-
     SnappedPoint s;
     bool success = false;
     bool strict_snapping = _snapmanager->snapprefs.getStrictSnapping();
+    Geom::Coord const tolerance = getSnapperTolerance();
 
-    for (std::vector<SnapCandidatePoint>::const_iterator k = _points_to_snap_to->begin(); k != _points_to_snap_to->end(); ++k) {
-        if (_allowSourceToSnapToTarget(p.getSourceType(), (*k).getTargetType(), strict_snapping)) {
-            Geom::Point target_pt = (*k).getPoint();
+    auto try_target = [&](SnapCandidatePoint const &target) {
+        if (_allowSourceToSnapToTarget(p.getSourceType(), target.getTargetType(), strict_snapping)) {
+            Geom::Point target_pt = target.getPoint();
             Geom::Coord dist = Geom::L2(target_pt - p.getPoint()); // Default: free (unconstrained) snapping
             if (!c.isUndefined()) {
                 // We're snapping to nodes along a constraint only, so find out if this node
@@ -302,16 +382,33 @@ void Inkscape::ObjectSnapper::_snapNodes(IntermSnapResults &isr,
                 if (Geom::L2(target_pt - c.projection(target_pt)) > 1e-9) {
                     // The distance from the target point to its projection on the constraint
                     // is too large, so this point is not on the constraint. Skip it!
-                    continue;
+                    return;
                 }
                 dist = Geom::L2(target_pt - p_proj_on_constraint);
             }
 
-            if (dist < getSnapperTolerance() && dist < s.getSnapDistance()) {
-                s = SnappedPoint(target_pt, p.getSourceType(), p.getSourceNum(), (*k).getTargetType(), dist, getSnapperTolerance(), getSnapperAlwaysSnap(), false, true, (*k).getTargetBBox());
+            if (dist < tolerance && dist < s.getSnapDistance()) {
+                s = SnappedPoint(target_pt, p.getSourceType(), p.getSourceNum(), target.getTargetType(), dist, tolerance, getSnapperAlwaysSnap(), false, true, target.getTargetBBox());
                 success = true;
             }
         }
+    };
+
+    // Only the nodes within the tolerance of the point being snapped can be snapped to. Visit them
+    // in the order they were collected in, so the same one wins when several are equally close.
+    Geom::Point const center = c.isUndefined() ? p.getPoint() : p_proj_on_constraint;
+    Geom::Point const range(tolerance, tolerance);
+    std::vector<unsigned> in_range;
+    _points_index->search(Geom::Rect(center - range, center + range), [&](unsigned i) { in_range.push_back(i); });
+    std::sort(in_range.begin(), in_range.end());
+    for (unsigned i : in_range) {
+        try_target((*_points_to_snap_to)[i]);
+    }
+
+    if (unselected_nodes != nullptr) {
+        for (auto const &unselected_node : *unselected_nodes) {
+            try_target(unselected_node);
+        }
     }
 
     if (success) {
@@ -376,10 +473,7 @@ void Inkscape::ObjectSnapper::_collectPaths(Geom::Point /*p*/,
 
         // Consider the page border for snapping
         if (_snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_PAGE_BORDER) && _snapmanager->snapprefs.isAnyCategorySnappable()) {
-            Geom::PathVector *border_path = _getBorderPathv();
-            if (border_path != nullptr) {
-                _paths_to_snap_to->push_back(SnapCandidatePath(border_path, SNAPTARGET_PAGE_BORDER, Geom::OptRect()));
-            }
+            _paths_to_snap_to->push_back(SnapCandidatePath(std::make_shared<SnapTargetPath>(_getBorderPathv()), SNAPTARGET_PAGE_BORDER, Geom::OptRect()));
         }
 
         for (std::vector<SnapCandidateItem>::const_iterator i = _candidates->begin(); i != _candidates->end(); ++i) {
@@ -408,9 +502,9 @@ void Inkscape::ObjectSnapper::_collectPaths(Geom::Point /*p*/,
                             // Snap to the text baseline
                             Text::Layout const *layout = te_get_layout(static_cast<SPItem *>(root_item));
                             if (layout != nullptr && layout->outputExists()) {
-                                Geom::PathVector *pv = new Geom::PathVector();
-                                pv->push_back(layout->baseline() * root_item->i2dt_affine() * (*i).additional_affine * _snapmanager->getDesktop()->doc2dt());
-                                _paths_to_snap_to->push_back(SnapCandidatePath(pv, SNAPTARGET_TEXT_BASELINE, Geom::OptRect()));
+                                Geom::PathVector pv;
+                                pv.push_back(layout->baseline() * root_item->i2dt_affine() * (*i).additional_affine * _snapmanager->getDesktop()->doc2dt());
+                                _paths_to_snap_to->push_back(SnapCandidatePath(std::make_shared<SnapTargetPath>(std::move(pv)), SNAPTARGET_TEXT_BASELINE, Geom::OptRect()));
                             }
                         }
                     } else {
@@ -424,20 +518,16 @@ void Inkscape::ObjectSnapper::_collectPaths(Geom::Point /*p*/,
                         }
 
                         if (!very_complex_path && root_item && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_PATH, SNAPTARGET_PATH_INTERSECTION)) {
-                            SPCurve *curve = nullptr;
+                            std::shared_ptr<SnapTargetPath const> pv;
                             SPShape *shape = dynamic_cast<SPShape *>(root_item);
                             if (shape) {
-                               curve = shape->getCurve();
+                                // The shape keeps the transformed path until it changes, so it is not rebuilt for every drag
+                                pv = shape->getSnapPath(root_item->i2dt_affine() * (*i).additional_affine * _snapmanager->getDesktop()->doc2dt()); // (_edit_transform * _i2d_transform);
                             }/* else if (dynamic_cast<SPText *>(root_item) || dynamic_cast<SPFlowtext *>(root_item)) {
                                curve = te_get_layout(root_item)->convertToCurves();
                             }*/
-                            if (curve) {
-                                // We will get our own copy of the pathvector, which must be freed at some point
-                                Geom::PathVector *pv = new Geom::PathVector(curve->get_pathvector());
-                                (*pv) *= root_item->i2dt_affine() * (*i).additional_affine * _snapmanager->getDesktop()->doc2dt(); // (_edit_transform * _i2d_transform);
-
-                                _paths_to_snap_to->push_back(SnapCandidatePath(pv, SNAPTARGET_PATH, Geom::OptRect())); // Perhaps for speed, get a reference to the Geom::pathvector, and store the transformation besides it.
-                                curve->unref();
+                            if (pv) {
+                                _paths_to_snap_to->push_back(SnapCandidatePath(pv, SNAPTARGET_PATH, Geom::OptRect()));
                             }
                         }
                     }
@@ -452,7 +542,7 @@ void Inkscape::ObjectSnapper::_collectPaths(Geom::Point /*p*/,
                     if (!(*i).clip_or_mask) {
                         Geom::OptRect rect = root_item->bounds(bbox_type, i2doc);
                         if (rect) {
-                            Geom::PathVector *path = _getPathvFromRect(*rect);
+                            auto path = std::make_shared<SnapTargetPath>(_getPathvFromRect(*rect));
                             rect = root_item->desktopBounds(bbox_type);
                             _paths_to_snap_to->push_back(SnapCandidatePath(path, SNAPTARGET_BBOX_EDGE, rect));
                         }
@@ -488,8 +578,7 @@ void Inkscape::ObjectSnapper::_snapPaths(IntermSnapResults &isr,
             // TODO fix the function to be const correct:
             SPCurve *curve = curve_for_item(const_cast<SPPath*>(selected_path));
             if (curve) {
-                Geom::PathVector *pathv = new Geom::PathVector(curve->get_pathvector()); // Must be freed.
-                *pathv *= selected_path->i2doc_affine();
+                auto pathv = std::make_shared<SnapTargetPath>(curve->get_pathvector() * selected_path->i2doc_affine());
                 _paths_to_snap_to->push_back(SnapCandidatePath(pathv, SNAPTARGET_PATH, Geom::OptRect(), true));
                 curve->unref();
             }
@@ -510,64 +599,58 @@ void Inkscape::ObjectSnapper::_snapPaths(IntermSnapResults &isr,
             bool const being_edited = node_tool_active && (*it_p).currently_being_edited;
             //if true then this pathvector it_pv is currently being edited in the node tool
 
-            for(Geom::PathVector::iterator it_pv = (it_p->path_vector)->begin(); it_pv != (it_p->path_vector)->end(); ++it_pv) {
-                // Find a nearest point for each curve within this path
-                // n curves will return n time values with 0 <= t <= 1
-                std::vector<double> anp = (*it_pv).nearestTimePerCurve(p_doc);
-
-                //std::cout << "#nearest points = " << anp.size() << " | p = " << p.getPoint() << std::endl;
-                // Now we will examine each of the nearest points, and determine whether it's within snapping range and if we should snap to it
-                std::vector<double>::const_iterator np = anp.begin();
-                unsigned int index = 0;
-                for (; np != anp.end(); ++np, index++) {
-                    Geom::Curve const *curve = &(it_pv->at(index));
-                    Geom::Point const sp_doc = curve->pointAt(*np);
-                    //dt->snapindicator->set_new_debugging_point(sp_doc*dt->doc2dt());
-                    bool c1 = true;
-                    bool c2 = true;
-                    if (being_edited) {
-                        /* If the path is being edited, then we should only snap though to stationary pieces of the path
-                         * and not to the pieces that are being dragged around. This way we avoid
-                         * self-snapping. For this we check whether the nodes at both ends of the current
-                         * piece are unselected; if they are then this piece must be stationary
-                         */
-                        g_assert(unselected_nodes != nullptr);
-                        Geom::Point start_pt = dt->doc2dt(curve->pointAt(0));
-                        Geom::Point end_pt = dt->doc2dt(curve->pointAt(1));
-                        c1 = isUnselectedNode(start_pt, unselected_nodes);
-                        c2 = isUnselectedNode(end_pt, unselected_nodes);
-                        /* Unfortunately, this might yield false positives for coincident nodes. Inkscape might therefore mistakenly
-                         * snap to path segments that are not stationary. There are at least two possible ways to overcome this:
-                         * - Linking the individual nodes of the SPPath we have here, to the nodes of the NodePath::SubPath class as being
-                         *   used in sp_nodepath_selected_nodes_move. This class has a member variable called "selected". For this the nodes
-                         *   should be in the exact same order for both classes, so we can index them
-                         * - Replacing the SPPath being used here by the NodePath::SubPath class; but how?
-                         */
-                    }
+            Geom::PathVector const &pathv = it_p->path->pathv();
+            // Only the curves whose bounding box is within range can have a point within range
+            for (auto const &path_and_curve : it_p->path->curvesNear(p_doc, getSnapperTolerance())) {
+                unsigned int const index = path_and_curve.second;
+                Geom::Curve const *curve = &(pathv[path_and_curve.first][index]);
+                Geom::Coord const np = curve->nearestTime(p_doc);
+                Geom::Point const sp_doc = curve->pointAt(np);
+                //dt->snapindicator->set_new_debugging_point(sp_doc*dt->doc2dt());
+                bool c1 = true;
+                bool c2 = true;
+                if (being_edited) {
+                    /* If the path is being edited, then we should only snap though to stationary pieces of the path
+                     * and not to the pieces that are being dragged around. This way we avoid
+                     * self-snapping. For this we check whether the nodes at both ends of the current
+                     * piece are unselected; if they are then this piece must be stationary
+                     */
+                    g_assert(unselected_nodes != nullptr);
+                    Geom::Point start_pt = dt->doc2dt(curve->pointAt(0));
+                    Geom::Point end_pt = dt->doc2dt(curve->pointAt(1));
+                    c1 = isUnselectedNode(start_pt, unselected_nodes);
+                    c2 = isUnselectedNode(end_pt, unselected_nodes);
+                    /* Unfortunately, this might yield false positives for coincident nodes. Inkscape might therefore mistakenly
+                     * snap to path segments that are not stationary. There are at least two possible ways to overcome this:
+                     * - Linking the individual nodes of the SPPath we have here, to the nodes of the NodePath::SubPath class as being
+                     *   used in sp_nodepath_selected_nodes_move. This class has a member variable called "selected". For this the nodes
+                     *   should be in the exact same order for both classes, so we can index them
+                     * - Replacing the SPPath being used here by the NodePath::SubPath class; but how?
+                     */
+                }
 
-                    Geom::Point const sp_dt = dt->doc2dt(sp_doc);
-                    if (!being_edited || (c1 && c2)) {
-                        Geom::Coord dist = Geom::distance(sp_doc, p_doc);
-                        // std::cout << "  dist -> " << dist << std::endl;
-                        if (dist < getSnapperTolerance()) {
-                            // Add the curve we have snapped to
-                            Geom::Point sp_tangent_dt = Geom::Point(0,0);
-                            if (p.getSourceType() == Inkscape::SNAPSOURCE_GUIDE_ORIGIN) {
-                                // We currently only use the tangent when snapping guides, so only in this case we will
-                                // actually calculate the tangent to avoid wasting CPU cycles
-                                Geom::Point sp_tangent_doc = curve->unitTangentAt(*np);
-                                sp_tangent_dt = dt->doc2dt(sp_tangent_doc) - dt->doc2dt(Geom::Point(0,0));
-                            }
-                            isr.curves.emplace_back(sp_dt, sp_tangent_dt, num_path, index, dist, getSnapperTolerance(), getSnapperAlwaysSnap(), false, curve, p.getSourceType(), p.getSourceNum(), it_p->target_type, it_p->target_bbox);
-                            if (snap_tang || snap_perp) {
-                                // For each curve that's within snapping range, we will now also search for tangential and perpendicular snaps
-                                _snapPathsTangPerp(snap_tang, snap_perp, isr, p, curve, dt);
-                            }
+                Geom::Point const sp_dt = dt->doc2dt(sp_doc);
+                if (!being_edited || (c1 && c2)) {
+                    Geom::Coord dist = Geom::distance(sp_doc, p_doc);
+                    // std::cout << "  dist -> " << dist << std::endl;
+                    if (dist < getSnapperTolerance()) {
+                        // Add the curve we have snapped to
+                        Geom::Point sp_tangent_dt = Geom::Point(0,0);
+                        if (p.getSourceType() == Inkscape::SNAPSOURCE_GUIDE_ORIGIN) {
+                            // We currently only use the tangent when snapping guides, so only in this case we will
+                            // actually calculate the tangent to avoid wasting CPU cycles
+                            Geom::Point sp_tangent_doc = curve->unitTangentAt(np);
+                            sp_tangent_dt = dt->doc2dt(sp_tangent_doc) - dt->doc2dt(Geom::Point(0,0));
+                        }
+                        isr.curves.emplace_back(sp_dt, sp_tangent_dt, num_path + path_and_curve.first, index, dist, getSnapperTolerance(), getSnapperAlwaysSnap(), false, curve, p.getSourceType(), p.getSourceNum(), it_p->target_type, it_p->target_bbox);
+                        if (snap_tang || snap_perp) {
+                            // For each curve that's within snapping range, we will now also search for tangential and perpendicular snaps
+                            _snapPathsTangPerp(snap_tang, snap_perp, isr, p, curve, dt);
                         }
                     }
                 }
-                num_path++;
-            } // End of: for (Geom::PathVector::iterator ....)
+            }
+            num_path += pathv.size();
         }
     }
 }
@@ -637,9 +720,9 @@ void Inkscape::ObjectSnapper::_snapPathsConstrained(IntermSnapResults &isr,
 
     // Find all intersections of the constrained path with the snap target candidates
     for (std::vector<SnapCandidatePath >::const_iterator k = _paths_to_snap_to->begin(); k != _paths_to_snap_to->end(); ++k) {
-        if (k->path_vector && _allowSourceToSnapToTarget(p.getSourceType(), (*k).target_type, strict_snapping)) {
+        if (k->path && _allowSourceToSnapToTarget(p.getSourceType(), (*k).target_type, strict_snapping)) {
             // Do the intersection math
-            std::vector<Geom::PVIntersection> inters = constraint_path.intersect(*(k->path_vector));
+            std::vector<Geom::PVIntersection> inters = constraint_path.intersect(k->path->pathv());
 
             // Convert the collected intersections to snapped points
             for (std::vector<Geom::PVIntersection>::const_iterator i = inters.begin(); i != inters.end(); ++i) {
@@ -671,7 +754,7 @@ void Inkscape::ObjectSnapper::freeSnap(IntermSnapResults &isr,
     /* Get a list of all the SPItems that we will try to snap to */
     if (p.getSourceNum() <= 0) {
         Geom::Rect const local_bbox_to_snap = bbox_to_snap ? *bbox_to_snap : Geom::Rect(p.getPoint(), p.getPoint());
-        _findCandidates(_snapmanager->getDocument()->getRoot(), it, p.getSourceNum() <= 0, local_bbox_to_snap, false, Geom::identity());
+        _findCandidates(it, local_bbox_to_snap);
     }
 
     _snapNodes(isr, p, unselected_nodes);
@@ -716,7 +799,7 @@ void Inkscape::ObjectSnapper::constrainedSnap( IntermSnapResults &isr,
     /* Get a list of all the SPItems that we will try to snap to */
     if (p.getSourceNum() <= 0) {
         Geom::Rect const local_bbox_to_snap = bbox_to_snap ? *bbox_to_snap : Geom::Rect(pp, pp);
-        _findCandidates(_snapmanager->getDocument()->getRoot(), it, p.getSourceNum() <= 0, local_bbox_to_snap, false, Geom::identity());
+        _findCandidates(it, local_bbox_to_snap);
     }
 
     // A constrained snap, is a snap in only one degree of freedom (specified by the constraint line).
@@ -737,27 +820,21 @@ bool Inkscape::ObjectSnapper::ThisSnapperMightSnap() const
 
 void Inkscape::ObjectSnapper::_clear_paths() const
 {
-    for (std::vector<SnapCandidatePath >::const_iterator k = _paths_to_snap_to->begin(); k != _paths_to_snap_to->end(); ++k) {
-        delete k->path_vector;
-    }
     _paths_to_snap_to->clear();
 }
 
-Geom::PathVector* Inkscape::ObjectSnapper::_getBorderPathv() const
+Geom::PathVector Inkscape::ObjectSnapper::_getBorderPathv() const
 {
     Geom::Rect const border_rect = Geom::Rect(Geom::Point(0,0), Geom::Point((_snapmanager->getDocument())->getWidth().value("px"),(_snapmanager->getDocument())->getHeight().value("px")));
     return _getPathvFromRect(border_rect);
 }
 
-Geom::PathVector* Inkscape::ObjectSnapper::_getPathvFromRect(Geom::Rect const rect) const
+Geom::PathVector Inkscape::ObjectSnapper::_getPathvFromRect(Geom::Rect const rect) const
 {
-    SPCurve const *border_curve = SPCurve::new_from_rect(rect, true);
-    if (border_curve) {
-        Geom::PathVector *dummy = new Geom::PathVector(border_curve->get_pathvector());
-        return dummy;
-    } else {
-        return nullptr;
-    }
+    SPCurve *border_curve = SPCurve::new_from_rect(rect, true);
+    Geom::PathVector pathv = border_curve->get_pathvector();
+    border_curve->unref();
+    return pathv;
 }
 
 void Inkscape::ObjectSnapper::_getBorderNodes(std::vector<SnapCandidatePoint> *points) const
@@ -11,6 +11,8 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <unordered_set>
+
 #include "snapper.h"
 #include "snap-candidate.h"
 
@@ -24,6 +26,10 @@ class SPDesktop;
 namespace Inkscape
 {
 
+namespace Util {
+template <typename T> class RTree;
+}
+
 /**
  * Snapping things to objects.
  */
@@ -65,19 +71,47 @@ private:
     std::vector<SnapCandidatePoint> *_points_to_snap_to;
     std::vector<SnapCandidatePath > *_paths_to_snap_to;
 
+    // Index of _points_to_snap_to, so we don't have to test all of them for each point we want to snap
+    Util::RTree<unsigned> *_points_index;
+
     /**
-     * Find all items within snapping range.
-     * @param parent Pointer to the document's root, or to a clipped path or mask object.
+     * Find all items within snapping range and store them in _candidates.
      * @param it List of items to ignore.
      * @param bbox_to_snap Bounding box hulling the whole bunch of points, all from the same selection and having the same transformation.
+     */
+    void _findCandidates(std::vector<SPItem const *> const *it,
+                         Geom::Rect const &bbox_to_snap) const;
+
+    /**
+     * Add the items below parent that are within snapping range to the candidates, walking the whole subtree.
+     * @param parent Pointer to the document's root, or to a clipped path or mask object.
+     * @param ignore Items to ignore.
+     * @param bbox_to_snap_incl Bounding box to snap, including the snapper tolerance.
      * @param clip_or_mask The parent object being passed is either a clip or mask.
+     * @return false if the limit of candidates has been reached.
+     */
+    bool _findCandidatesInTree(SPObject* parent,
+                               std::unordered_set<SPItem const *> const &ignore,
+                               Geom::Rect const &bbox_to_snap_incl,
+                               bool const clip_or_mask,
+                               Geom::Affine const additional_affine) const;
+
+    /**
+     * Add the children of the clipping path and mask of item to the candidates, if these are snapped to.
+     * @return false if the limit of candidates has been reached.
+     */
+    bool _findClipAndMaskCandidates(SPItem *item,
+                                    std::unordered_set<SPItem const *> const &ignore,
+                                    Geom::Rect const &bbox_to_snap_incl) const;
+
+    /**
+     * Add item to the candidates if its bounding box is within range.
+     * @return false if the limit of candidates has been reached.
      */
-    void _findCandidates(SPObject* parent,
-                       std::vector<SPItem const *> const *it,
-                       bool const &first_point,
-                       Geom::Rect const &bbox_to_snap,
-                       bool const _clip_or_mask,
-                       Geom::Affine const additional_affine) const;
+    bool _addCandidate(SPItem *item,
+                       Geom::Rect const &bbox_to_snap_incl,
+                       bool const clip_or_mask,
+                       Geom::Affine const &additional_affine) const;
 
     void _snapNodes(IntermSnapResults &isr,
                       Inkscape::SnapCandidatePoint const &p, // in desktop coordinates
@@ -119,8 +153,8 @@ private:
                       bool const &first_point) const;
 
     void _clear_paths() const;
-    Geom::PathVector* _getBorderPathv() const;
-    Geom::PathVector* _getPathvFromRect(Geom::Rect const rect) const;
+    Geom::PathVector _getBorderPathv() const;
+    Geom::PathVector _getPathvFromRect(Geom::Rect const rect) const;
     void _getBorderNodes(std::vector<SnapCandidatePoint> *points) const;
     bool _allowSourceToSnapToTarget(SnapSourceType source, SnapTargetType target, bool strict_snapping) const;
 
@@ -12,10 +12,12 @@
 
 #include <sigc++/sigc++.h>
 #include <glib.h>
+#include <unordered_set>
 #include "object-set.h"
 #include "box3d.h"
 #include "persp3d.h"
 #include "preferences.h"
+#include "sp-root.h"
 #include <boost/range/adaptor/filtered.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 
@@ -115,6 +117,7 @@ void ObjectSet::_disconnect(SPObject *object) {
 void ObjectSet::_remove(SPObject *object) {
     _disconnect(object);
     _container.get<hashed>().erase(object);
+    _invalidateBounds();
 }
 
 void ObjectSet::_add(SPObject *object) {
@@ -122,12 +125,81 @@ void ObjectSet::_add(SPObject *object) {
     _container.push_back(object);
     _add3DBoxesRecursively(object);
     _connectSignals(object);
+
+    if (auto item = dynamic_cast<SPItem *>(object)) {
+        if (_visual_bounds_valid) {
+            _visual_bounds.unionWith(item->documentVisualBounds());
+        }
+        if (_geometric_bounds_valid) {
+            _geometric_bounds.unionWith(item->documentGeometricBounds());
+        }
+    }
+}
+
+/**
+ * Adds objects the way add() does one by one, without emitting signals.
+ *
+ * Only the objects without an ancestor in the set or among the new objects are kept, which
+ * is found by looking up the ancestors of each object instead of walking the subtrees.
+ */
+void ObjectSet::_addList(std::vector<SPObject *> const &objects) {
+    std::unordered_set<SPObject *> added;
+    added.reserve(objects.size());
+    for (auto object : objects) {
+        if (object && !includes(object)) {
+            added.insert(object);
+        }
+    }
+    if (added.empty()) {
+        return;
+    }
+
+    // remove the objects that are now covered by one of their ancestors
+    std::vector<SPObject *> covered;
+    for (auto object : _container) {
+        for (SPObject *o = object->parent; o != nullptr; o = o->parent) {
+            if (added.count(o)) {
+                covered.push_back(object);
+                break;
+            }
+        }
+    }
+    for (auto object : covered) {
+        _remove(object);
+    }
+
+    for (auto object : objects) {
+        if (!added.count(object) || includes(object)) {
+            continue;
+        }
+        bool ancestor_in_set = false;
+        for (SPObject *o = object->parent; o != nullptr; o = o->parent) {
+            if (added.count(o) || includes(o)) {
+                ancestor_in_set = true;
+                break;
+            }
+        }
+        if (!ancestor_in_set) {
+            _add(object);
+        }
+    }
 }
 
 void ObjectSet::_clear() {
-    for (auto object: _container)
-        _disconnect(object);
+    for (auto object: _container) {
+        _releaseConnections[object].disconnect();
+        _releaseSignals(object);
+    }
+    // all boxes go at once, rather than looking up the boxes of each object
+    _releaseConnections.clear();
+    _3dboxes.clear();
     _container.clear();
+    _invalidateBounds();
+}
+
+void ObjectSet::_invalidateBounds() {
+    _visual_bounds_valid = false;
+    _geometric_bounds_valid = false;
 }
 
 SPObject *ObjectSet::_getMutualAncestor(SPObject *object) {
@@ -248,16 +320,16 @@ void ObjectSet::set(SPObject *object, bool persist_selection_context) {
 void ObjectSet::setReprList(std::vector<XML::Node*> const &list) {
     if(!document())
         return;
-    clear();
+    _clear();
+    std::vector<SPObject *> objects;
     for (auto iter = list.rbegin(); iter != list.rend(); ++iter) {
         SPObject *obj = document()->getObjectById((*iter)->attribute("id"));
         if (obj) {
-            add(obj, true);
+            objects.push_back(obj);
         }
     }
+    _addList(objects);
     _emitSignals();
-    if(dynamic_cast<Inkscape::Selection*>(this))
-        return dynamic_cast<Inkscape::Selection*>(this)->_emitChanged();//
 }
 
 
@@ -270,22 +342,20 @@ Geom::OptRect ObjectSet::bounds(SPItem::BBoxType type) const
 
 Geom::OptRect ObjectSet::geometricBounds() const
 {
-    auto items = const_cast<ObjectSet *>(this)->items();
-
-    Geom::OptRect bbox;
-    for (auto iter = items.begin(); iter != items.end(); ++iter) {
-        bbox.unionWith(SP_ITEM(*iter)->desktopGeometricBounds());
+    Geom::OptRect bbox = documentBounds(SPItem::GEOMETRIC_BBOX);
+    if (bbox) {
+        SPItem *item = *const_cast<ObjectSet *>(this)->items().begin();
+        *bbox *= item->document->doc2dt();
     }
     return bbox;
 }
 
 Geom::OptRect ObjectSet::visualBounds() const
 {
-    auto items = const_cast<ObjectSet *>(this)->items();
-
-    Geom::OptRect bbox;
-    for (auto iter = items.begin(); iter != items.end(); ++iter) {
-        bbox.unionWith(SP_ITEM(*iter)->desktopVisualBounds());
+    Geom::OptRect bbox = documentBounds(SPItem::VISUAL_BBOX);
+    if (bbox) {
+        SPItem *item = *const_cast<ObjectSet *>(this)->items().begin();
+        *bbox *= item->document->doc2dt();
     }
     return bbox;
 }
@@ -303,13 +373,30 @@ Geom::OptRect ObjectSet::documentBounds(SPItem::BBoxType type) const
 {
     Geom::OptRect bbox;
     auto items = const_cast<ObjectSet *>(this)->items();
-    if (items.empty()) return bbox;
+    if (items.empty()) {
+        return bbox;
+    }
+
+    // Items changed since the last update of the document, e.g. by setting their transform,
+    // have not sent their modification signals yet, so the cache may be out of date
+    SPRoot const *root = (*items.begin())->document->getRoot();
+    bool const update_pending = root && (root->uflags || root->mflags);
+
+    bool &valid = (type == SPItem::GEOMETRIC_BBOX) ? _geometric_bounds_valid : _visual_bounds_valid;
+    Geom::OptRect &cached = (type == SPItem::GEOMETRIC_BBOX) ? _geometric_bounds : _visual_bounds;
+    if (valid && !update_pending) {
+        return cached;
+    }
 
     for (auto iter = items.begin(); iter != items.end(); ++iter) {
         SPItem *item = SP_ITEM(*iter);
         bbox |= item->documentBounds(type);
     }
 
+    if (_tracksModification() && !update_pending) {
+        cached = bbox;
+        valid = true;
+    }
     return bbox;
 }
 
@@ -164,9 +164,7 @@ public:
      */
     template <typename InputIterator>
     void add(InputIterator from, InputIterator to) {
-        for(auto it = from; it != to; ++it) {
-            _add(*it);
-        }
+        _addList(std::vector<SPObject *>(from, to));
         _emitSignals();
     }
 
@@ -300,11 +298,7 @@ public:
     template <class T>
     typename boost::enable_if<boost::is_base_of<SPObject, T>, void>::type
     addList(const std::vector<T*> &objs) {
-        for (auto obj: objs) {
-            if (!includes(obj)) {
-                add(obj, true);
-            }
-        }
+        _addList(std::vector<SPObject *>(objs.begin(), objs.end()));
         _emitSignals();
     }
 
@@ -464,6 +458,7 @@ protected:
     virtual void _releaseSignals(SPObject* object) {};
     virtual void _emitSignals() {};
     void _add(SPObject* object);
+    void _addList(std::vector<SPObject *> const &objects);
     void _clear();
     void _remove(SPObject* object);
     bool _anyAncestorIsInSet(SPObject *object);
@@ -473,12 +468,20 @@ protected:
     SPObject *_getMutualAncestor(SPObject *object);
     virtual void _add3DBoxesRecursively(SPObject *obj);
     virtual void _remove3DBoxesRecursively(SPObject *obj);
+    /// Whether the set hears about modifications of its items, so that their bounds can be kept
+    virtual bool _tracksModification() const { return false; }
+    void _invalidateBounds();
 
     MultiIndexContainer _container;
     GC::soft_ptr<SPDesktop> _desktop;
     GC::soft_ptr<SPDocument> _document;
     std::list<SPBox3D *> _3dboxes;
     std::unordered_map<SPObject*, sigc::connection> _releaseConnections;
+    /// Union of the document bounds of the items, extended as items are added
+    mutable Geom::OptRect _visual_bounds;
+    mutable Geom::OptRect _geometric_bounds;
+    mutable bool _visual_bounds_valid = false;
+    mutable bool _geometric_bounds_valid = false;
 
 private:
     BoolOpErrors pathBoolOp(bool_op bop, const bool skip_undo, const bool checked = false, const unsigned int verb = SP_VERB_NONE, const Glib::ustring description = "");
@@ -39,6 +39,7 @@
 #include "sp-clippath.h"
 #include "xml/quote.h"
 #include "preferences.h"
+#include "inkscape.h"
 #include "io/sys.h"
 
 #if defined(HAVE_LIBLCMS2)
@@ -68,8 +69,10 @@
 
 static void sp_image_set_curve(SPImage *image);
 
-static Inkscape::Pixbuf *sp_image_repr_read_image(gchar const *href, gchar const *absref, gchar const *base,
-                                                  double svgdpi = 0);
+static std::shared_ptr<Inkscape::Pixbuf> sp_image_repr_read_image(gchar const *href, gchar const *absref,
+                                                                  gchar const *base, double svgdpi = 0);
+static std::shared_ptr<Inkscape::PendingPixbuf> sp_image_repr_read_image_async(gchar const *href, gchar const *base,
+                                                                               double svgdpi);
 static void sp_image_update_arenaitem (SPImage *img, Inkscape::DrawingImage *ai);
 static void sp_image_update_canvas_image (SPImage *image);
 
@@ -123,7 +126,6 @@ SPImage::SPImage() : SPItem(), SPViewBox() {
 #if defined(HAVE_LIBLCMS2)
     this->color_profile = nullptr;
 #endif // defined(HAVE_LIBLCMS2)
-    this->pixbuf = nullptr;
 }
 
 SPImage::~SPImage() = default;
@@ -155,8 +157,8 @@ void SPImage::release() {
         this->href = nullptr;
     }
 
-    delete this->pixbuf;
-    this->pixbuf = nullptr;
+    this->pixbuf.reset();
+    _cancelPending();
 
 #if defined(HAVE_LIBLCMS2)
     if (this->color_profile) {
@@ -330,21 +332,45 @@ void SPImage::update(SPCtx *ctx, unsigned int flags) {
 
     SPItem::update(ctx, flags);
     if (flags & SP_IMAGE_HREF_MODIFIED_FLAG) {
-        delete this->pixbuf;
-        this->pixbuf = nullptr;
+        this->pixbuf.reset();
+        _cancelPending();
         if (this->href) {
-            Inkscape::Pixbuf *pixbuf = nullptr;
+            std::shared_ptr<Inkscape::Pixbuf> pixbuf;
             double svgdpi = 96;
             if (this->getRepr()->attribute("inkscape:svg-dpi")) {
                 svgdpi = atof(this->getRepr()->attribute("inkscape:svg-dpi"));
             }
             this->dpi = svgdpi;
-            pixbuf = sp_image_repr_read_image(this->getRepr()->attribute("xlink:href"),
-                                              this->getRepr()->attribute("sodipodi:absref"), doc->getDocumentBase(), svgdpi);
+
+            // In the editor, linked files are decoded in the background, so that opening a
+            // document with large photos does not block; the canvas shows a placeholder meanwhile.
+            bool async = Inkscape::Application::exists() && INKSCAPE.use_gui();
+#if defined(HAVE_LIBLCMS2)
+            async = async && !this->color_profile;
+#endif
+            if (async) {
+                this->pending = sp_image_repr_read_image_async(this->getRepr()->attribute("xlink:href"),
+                                                               doc->getDocumentBase(), svgdpi);
+            }
+            if (this->pending && this->pending->done()) {
+                pixbuf = this->pending->wait();
+                this->pending.reset();
+            }
+
+            if (this->pending) {
+                _pending_done_connection = this->pending->signal_done.connect(sigc::mem_fun(*this, &SPImage::ensurePixbuf));
+            } else if (!pixbuf) {
+                pixbuf = sp_image_repr_read_image(this->getRepr()->attribute("xlink:href"),
+                                                  this->getRepr()->attribute("sodipodi:absref"), doc->getDocumentBase(), svgdpi);
+            }
 
             if (pixbuf) {
 #if defined(HAVE_LIBLCMS2)
-                if ( this->color_profile ) apply_profile( pixbuf );
+                if ( this->color_profile ) {
+                    // the decoded image is shared, correct a copy of it
+                    pixbuf.reset(new Inkscape::Pixbuf(*pixbuf));
+                    apply_profile( pixbuf.get() );
+                }
 #endif
                 this->pixbuf = pixbuf;
             }
@@ -353,9 +379,20 @@ void SPImage::update(SPCtx *ctx, unsigned int flags) {
 
     SPItemCtx *ictx = (SPItemCtx *) ctx;
 
+    // Size of the image in pixels, known from the file header while it is decoded
+    int pixel_width = 0;
+    int pixel_height = 0;
+    if (this->pixbuf) {
+        pixel_width = this->pixbuf->width();
+        pixel_height = this->pixbuf->height();
+    } else if (this->pending) {
+        pixel_width = this->pending->width();
+        pixel_height = this->pending->height();
+    }
+
     // Why continue without a pixbuf? So we can display "Missing Image" png.
     // Eventually, we should properly support SVG image type (i.e. render it ourselves).
-    if (this->pixbuf) {
+    if (pixel_width) {
         if (!this->x._set) {
             this->x.unit = SVGLength::PX;
             this->x.computed = 0;
@@ -368,12 +405,12 @@ void SPImage::update(SPCtx *ctx, unsigned int flags) {
 
         if (!this->width._set) {
             this->width.unit = SVGLength::PX;
-            this->width.computed = this->pixbuf->width();
+            this->width.computed = pixel_width;
         }
 
         if (!this->height._set) {
             this->height.unit = SVGLength::PX;
-            this->height.computed = this->pixbuf->height();
+            this->height.computed = pixel_height;
         }
     }
 
@@ -389,10 +426,10 @@ void SPImage::update(SPCtx *ctx, unsigned int flags) {
     this->ox = this->x.computed;
     this->oy = this->y.computed;
 
-    if (this->pixbuf) {
+    if (pixel_width) {
 
         // Viewbox is either from SVG (not supported) or dimensions of pixbuf (PNG, JPG)
-        this->viewBox = Geom::Rect::from_xywh(0, 0, this->pixbuf->width(), this->pixbuf->height()); 
+        this->viewBox = Geom::Rect::from_xywh(0, 0, pixel_width, pixel_height);
         this->viewBox_set = true;
 
         // SPItemCtx rctx =
@@ -411,16 +448,16 @@ void SPImage::update(SPCtx *ctx, unsigned int flags) {
     sp_image_update_canvas_image ((SPImage *) this);
 
     // don't crash with missing xlink:href attribute
-    if (!this->pixbuf) {
+    if (!pixel_width) {
         return;
     }
 
-    double proportion_pixbuf = this->pixbuf->height() / (double)this->pixbuf->width();
+    double proportion_pixbuf = pixel_height / (double)pixel_width;
     double proportion_image = this->height.computed / (double)this->width.computed;
     if (this->prev_width &&
-        (this->prev_width != this->pixbuf->width() || this->prev_height != this->pixbuf->height())) {
-        if (std::abs(this->prev_width - this->pixbuf->width()) > std::abs(this->prev_height - this->pixbuf->height())) {
-            proportion_pixbuf = this->pixbuf->width() / (double)this->pixbuf->height();
+        (this->prev_width != pixel_width || this->prev_height != pixel_height)) {
+        if (std::abs(this->prev_width - pixel_width) > std::abs(this->prev_height - pixel_height)) {
+            proportion_pixbuf = pixel_width / (double)pixel_height;
             proportion_image = this->width.computed / (double)this->height.computed;
             if (proportion_pixbuf != proportion_image) {
                 double new_height = this->height.computed * proportion_pixbuf;
@@ -434,8 +471,8 @@ void SPImage::update(SPCtx *ctx, unsigned int flags) {
             }
         }
     }
-    this->prev_width = this->pixbuf->width();
-    this->prev_height = this->pixbuf->height();
+    this->prev_width = pixel_width;
+    this->prev_height = pixel_height;
 }
 
 void SPImage::modified(unsigned int flags) {
@@ -499,6 +536,7 @@ Geom::OptRect SPImage::bbox(Geom::Affine const &transform, SPItem::BBoxType /*ty
 }
 
 void SPImage::print(SPPrintContext *ctx) {
+    ensurePixbuf();
     if (this->pixbuf && (this->width.computed > 0.0) && (this->height.computed > 0.0) ) {
         Inkscape::Pixbuf *pb = new Inkscape::Pixbuf(*this->pixbuf);
         pb->ensurePixelFormat(Inkscape::Pixbuf::PF_GDK);
@@ -536,17 +574,22 @@ gchar* SPImage::description() const {
         href_desc = g_strdup("(null_pointer)"); // we call g_free() on href_desc
     }
 
-    char *ret = ( this->pixbuf == nullptr
-                  ? g_strdup_printf(_("[bad reference]: %s"), href_desc)
-                  : g_strdup_printf(_("%d &#215; %d: %s"),
+    char *ret = ( this->pixbuf
+                  ? g_strdup_printf(_("%d &#215; %d: %s"),
                                     this->pixbuf->width(),
                                     this->pixbuf->height(),
-                                    href_desc) );
+                                    href_desc)
+                  : this->pending
+                  ? g_strdup_printf(_("%d &#215; %d: %s"),
+                                    this->pending->width(),
+                                    this->pending->height(),
+                                    href_desc)
+                  : g_strdup_printf(_("[bad reference]: %s"), href_desc) );
                                     
-    if (this->pixbuf == nullptr && 
+    if (this->pixbuf == nullptr && this->pending == nullptr &&
         this->document) 
     {
-        Inkscape::Pixbuf * pb = nullptr;
+        std::shared_ptr<Inkscape::Pixbuf> pb;
         double svgdpi = 96;
         if (this->getRepr()->attribute("inkscape:svg-dpi")) {
             svgdpi = atof(this->getRepr()->attribute("inkscape:svg-dpi"));
@@ -559,7 +602,6 @@ gchar* SPImage::description() const {
                                         pb->width(),
                                         pb->height(),
                                         href_desc);
-            delete pb;
         }
     }
 
@@ -589,9 +631,9 @@ static std::string broken_image_svg = R"A(
 </svg>
 )A";
 
-Inkscape::Pixbuf *sp_image_repr_read_image(gchar const *href, gchar const *absref, gchar const *base, double svgdpi)
+std::shared_ptr<Inkscape::Pixbuf> sp_image_repr_read_image(gchar const *href, gchar const *absref, gchar const *base, double svgdpi)
 {
-    Inkscape::Pixbuf *inkpb = nullptr;
+    std::shared_ptr<Inkscape::Pixbuf> inkpb;
 
     gchar const *filename = href;
     
@@ -599,17 +641,17 @@ Inkscape::Pixbuf *sp_image_repr_read_image(gchar const *href, gchar const *absre
         if (g_ascii_strncasecmp(filename, "data:", 5) == 0) {
             /* data URI - embedded image */
             filename += 5;
-            inkpb = Inkscape::Pixbuf::create_from_data_uri(filename, svgdpi);
+            inkpb = Inkscape::Pixbuf::get_from_data_uri(filename, svgdpi);
         } else {
             auto url = Inkscape::URI::from_href_and_basedir(href, base);
 
             if (url.hasScheme("file")) {
                 auto native = url.toNativeFilename();
-                inkpb = Inkscape::Pixbuf::create_from_file(native.c_str(), svgdpi);
+                inkpb = Inkscape::Pixbuf::get_from_file(native, svgdpi);
             } else {
                 try {
                     auto contents = url.getContents();
-                    inkpb = Inkscape::Pixbuf::create_from_buffer(contents, svgdpi);
+                    inkpb.reset(Inkscape::Pixbuf::create_from_buffer(contents, svgdpi));
                 } catch (const Gio::Error &e) {
                     g_warning("URI::getContents failed for '%.100s'", href);
                 }
@@ -631,7 +673,7 @@ Inkscape::Pixbuf *sp_image_repr_read_image(gchar const *href, gchar const *absre
             g_warning ("xlink:href did not resolve to a valid image file, now trying sodipodi:absref=\"%s\"", absref);
         }
 
-        inkpb = Inkscape::Pixbuf::create_from_file(filename, svgdpi);
+        inkpb = Inkscape::Pixbuf::get_from_file(filename, svgdpi);
         if (inkpb != nullptr) {
             return inkpb;
         }
@@ -639,7 +681,7 @@ Inkscape::Pixbuf *sp_image_repr_read_image(gchar const *href, gchar const *absre
 
     /* Nope: We do not find any valid pixmap file :-( */
     // Need a "fake" filename to trigger svg mode.
-    inkpb = Inkscape::Pixbuf::create_from_buffer(broken_image_svg, 0, "brokenimage.svg");
+    inkpb.reset(Inkscape::Pixbuf::create_from_buffer(broken_image_svg, 0, "brokenimage.svg"));
 
     /* It's included here so if it still does not does load, */
     /* our libraries are broken! */
@@ -648,12 +690,60 @@ Inkscape::Pixbuf *sp_image_repr_read_image(gchar const *href, gchar const *absre
     return inkpb;
 }
 
+/**
+ * Starts decoding a linked raster image file in the background. Returns null for embedded,
+ * remote and SVG images, which sp_image_repr_read_image() has to load.
+ */
+static std::shared_ptr<Inkscape::PendingPixbuf> sp_image_repr_read_image_async(gchar const *href, gchar const *base,
+                                                                               double svgdpi)
+{
+    if (href == nullptr || g_ascii_strncasecmp(href, "data:", 5) == 0) {
+        return nullptr;
+    }
+    auto url = Inkscape::URI::from_href_and_basedir(href, base);
+    if (url.hasScheme("file")) {
+        return Inkscape::Pixbuf::get_from_file_async(url.toNativeFilename(), svgdpi);
+    }
+    return nullptr;
+}
+
+/**
+ * Finishes decoding the image if it is still pending, for code that needs its pixels.
+ */
+void SPImage::ensurePixbuf()
+{
+    if (!this->pending) {
+        return;
+    }
+    std::shared_ptr<Inkscape::PendingPixbuf> pending = this->pending;
+    _cancelPending();
+
+    this->pixbuf = pending->wait();
+    if (!this->pixbuf) {
+        // not an image after all, fall back to absref and the broken image, whose size must
+        // not be taken for a change of the linked file
+        this->prev_width = 0;
+        this->prev_height = 0;
+        this->pixbuf = sp_image_repr_read_image(this->getRepr()->attribute("xlink:href"),
+                                                this->getRepr()->attribute("sodipodi:absref"),
+                                                this->document->getDocumentBase(), this->dpi);
+    }
+    requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG);
+}
+
+void SPImage::_cancelPending()
+{
+    _pending_done_connection.disconnect();
+    this->pending.reset();
+}
+
 /* We assert that realpixbuf is either NULL or identical size to pixbuf */
 static void
 sp_image_update_arenaitem (SPImage *image, Inkscape::DrawingImage *ai)
 {
     ai->setStyle(SP_OBJECT(image)->style);
-    ai->setPixbuf(image->pixbuf);
+    ai->setPixbuf(image->pixbuf.get());
+    ai->setPending(image->pending);
     ai->setOrigin(Geom::Point(image->ox, image->oy));
     ai->setScale(image->sx, image->sy);
     ai->setClipbox(image->clipbox);
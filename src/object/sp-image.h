@@ -19,7 +19,9 @@
 # include "config.h"  // only include where actually required!
 #endif
 
+#include <memory>
 #include <glibmm/ustring.h>
+#include <sigc++/connection.h>
 #include "svg/svg-length.h"
 #include "display/curve.h"
 #include "sp-item.h"
@@ -31,7 +33,7 @@
 
 #define SP_IMAGE_HREF_MODIFIED_FLAG SP_OBJECT_USER_MODIFIED_FLAG_A
 
-namespace Inkscape { class Pixbuf; }
+namespace Inkscape { class Pixbuf; class PendingPixbuf; }
 class SPImage : public SPItem, public SPViewBox, public SPDimensions {
 public:
     SPImage();
@@ -50,7 +52,9 @@ public:
     char *color_profile;
 #endif // defined(HAVE_LIBLCMS2)
 
-    Inkscape::Pixbuf *pixbuf;
+    std::shared_ptr<Inkscape::Pixbuf> pixbuf;
+    /// Set instead of pixbuf while the image file is decoded in the background
+    std::shared_ptr<Inkscape::PendingPixbuf> pending;
 
     void build(SPDocument *document, Inkscape::XML::Node *repr) override;
     void release() override;
@@ -73,6 +77,12 @@ public:
 
     SPCurve *get_curve () const;
     void refresh_if_outdated();
+    void ensurePixbuf();
+
+private:
+    void _cancelPending();
+
+    sigc::connection _pending_done_connection;
 };
 
 /* Return duplicate of curve or NULL */
@@ -157,7 +157,9 @@ void SPGroup::update(SPCtx *ctx, unsigned int flags) {
       childflags |= SP_OBJECT_PARENT_MODIFIED_FLAG;
     }
     childflags &= SP_OBJECT_MODIFIED_CASCADE;
-    std::vector<SPObject*> l=this->childList(true, SPObject::ActionUpdate);
+    // Without flags to pass on, only the children that need an update are visited
+    std::vector<SPObject*> l = childflags ? this->childList(true, SPObject::ActionUpdate)
+                                          : this->dirtyChildList();
     for(std::vector<SPObject*> ::const_iterator i=l.begin();i!=l.end();++i){
         SPObject *child = *i;
 
@@ -208,7 +210,7 @@ void SPGroup::modified(guint flags) {
         }
     }
 
-    std::vector<SPObject*> l=this->childList(true);
+    std::vector<SPObject*> l = flags ? this->childList(true) : this->dirtyChildList(true);
     for(std::vector<SPObject*>::const_iterator i=l.begin();i!=l.end();++i){
         SPObject *child = *i;
 
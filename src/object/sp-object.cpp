@@ -64,6 +64,8 @@
 unsigned SPObject::indent_level = 0;
 
 guint update_in_progress = 0; // guard against update-during-update
+guint update_object_count = 0;   // objects updated since the document last reset it, for instrumentation
+guint modified_object_count = 0; // objects that emitted modified since the document last reset it
 
 Inkscape::XML::NodeEventVector object_event_vector = {
     SPObject::repr_child_added,
@@ -413,6 +415,18 @@ std::vector<SPObject*> SPObject::childList(bool add_ref, Action) {
     return l;
 }
 
+std::vector<SPObject*> SPObject::dirtyChildList(bool modified) {
+    std::vector<SPObject*> l;
+    for (auto& child: children) {
+        unsigned const flags = modified ? child.mflags : child.uflags;
+        if (flags & (SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_CHILD_MODIFIED_FLAG)) {
+            sp_object_ref(&child);
+            l.push_back(&child);
+        }
+    }
+    return l;
+}
+
 gchar const *SPObject::label() const {
     return _label;
 }
@@ -541,6 +555,10 @@ void SPObject::attach(SPObject *object, SPObject *prev)
     }
     children.insert(it, *object);
 
+    if (document) {
+        document->_itemAdded(object);
+    }
+
     if (!object->xml_space.set)
         object->xml_space.value = this->xml_space.value;
 }
@@ -558,6 +576,10 @@ void SPObject::reorder(SPObject* obj, SPObject* prev) {
     }
 
     children.splice(it, children, children.iterator_to(*obj));
+
+    if (document) {
+        document->_itemReordered(obj);
+    }
 }
 
 void SPObject::detach(SPObject *object)
@@ -568,6 +590,9 @@ void SPObject::detach(SPObject *object)
     g_return_if_fail(SP_IS_OBJECT(object));
     g_return_if_fail(object->parent == this);
 
+    if (document) {
+        document->_itemRemoved(object);
+    }
     children.erase(children.iterator_to(*object));
     object->releaseReferences();
 
@@ -1258,6 +1283,7 @@ void SPObject::updateDisplay(SPCtx *ctx, unsigned int flags)
 #endif
 
     update_in_progress ++;
+    update_object_count ++;
 
 #ifdef SP_OBJECT_DEBUG_CASCADE
     g_print("Update %s:%s %x %x %x\n", g_type_name_from_instance((GTypeInstance *) this), getId(), flags, this->uflags, this->mflags);
@@ -1349,6 +1375,8 @@ void SPObject::emitModified(unsigned int flags)
     g_print("Modified %s:%s %x %x %x\n", g_type_name_from_instance((GTypeInstance *) this), getId(), flags, this->uflags, this->mflags);
 #endif
 
+    modified_object_count ++;
+
     flags |= this->mflags;
     /* We have to clear mflags beforehand, as signal handlers may
      * make changes and therefore queue new modification notifications
@@ -1357,6 +1385,10 @@ void SPObject::emitModified(unsigned int flags)
 
     sp_object_ref(this);
 
+    if (document) {
+        document->_itemModified(this);
+    }
+
     this->modified(flags);
 
     _modified_signal.emit(this, flags);
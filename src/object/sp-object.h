@@ -307,6 +307,12 @@ public:
      */
     std::vector<SPObject*> childList(bool add_ref, Action action = ActionGeneral);
 
+    /**
+     * Retrieves the ref'ed children that have requested an update, or a modified
+     * notification if modified is specified, for themselves or their descendants.
+     */
+    std::vector<SPObject*> dirtyChildList(bool modified = false);
+
     /**
      * Append repr as child of this object.
      * \pre this is not a cloned object
@@ -105,6 +105,8 @@ void SPShape::release() {
         this->_curve_before_lpe = this->_curve_before_lpe->unref();
     }
 
+    _snap_path_cache.reset();
+
     SPLPEItem::release();
 }
 
@@ -124,6 +126,8 @@ void SPShape::update(SPCtx* ctx, guint flags) {
     // But the idle checker usually is just moving the objects around.
     bbox_vis_cache_is_valid = false;
     bbox_geom_cache_is_valid = false;
+    // The same goes for the snap path: some subclasses transform their curve in place
+    _snap_path_cache.reset();
 
     // std::cout << "SPShape::update(): " << (getId()?getId():"null") << std::endl;
     SPLPEItem::update(ctx, flags);
@@ -1108,6 +1112,8 @@ void SPShape::set_shape() {
  */
 void SPShape::setCurve(SPCurve *new_curve, unsigned int owner)
 {
+    _snap_path_cache.reset();
+
     if (_curve) {
         _curve = _curve->unref();
     }
@@ -1148,6 +1154,8 @@ SPShape::setCurveBeforeLPE(SPCurve *new_curve, unsigned int owner)
  */
 void SPShape::setCurveInsync(SPCurve *new_curve, unsigned int owner)
 {
+    _snap_path_cache.reset();
+
     if (_curve) {
         _curve = _curve->unref();
     }
@@ -1162,6 +1170,17 @@ void SPShape::setCurveInsync(SPCurve *new_curve, unsigned int owner)
 }
 
 
+std::shared_ptr<Inkscape::SnapTargetPath const> SPShape::getSnapPath(Geom::Affine const &transform) const
+{
+    if (!_curve) {
+        return nullptr;
+    }
+    if (!_snap_path_cache || _snap_path_cache->transform() != transform) {
+        _snap_path_cache = std::make_shared<Inkscape::SnapTargetPath>(_curve->get_pathvector() * transform, transform);
+    }
+    return _snap_path_cache;
+}
+
 /**
  * Return curve (if any exists) or NULL if there is no curve
  * if owner == 0 return a copy
@@ -18,6 +18,7 @@
 
 #include <2geom/forward.h>
 #include <cstddef>
+#include <memory>
 #include <sigc++/connection.h>
 
 #include "sp-lpe-item.h"
@@ -57,11 +58,21 @@ public:
     mutable Geom::OptRect bbox_geom_cache;
     mutable Geom::OptRect bbox_vis_cache;
 
+    /**
+     * Returns the curve transformed by transform for snapping to, or null if there is no curve.
+     * The result is kept until the shape is updated or another transform is asked for.
+     */
+    std::shared_ptr<Inkscape::SnapTargetPath const> getSnapPath(Geom::Affine const &transform) const;
+
 
 public: // temporarily public, until SPPath is properly classed, etc.
     SPCurve *_curve_before_lpe;
     SPCurve *_curve;
 
+private:
+    // snap path cache, dropped when the shape changes
+    mutable std::shared_ptr<Inkscape::SnapTargetPath const> _snap_path_cache;
+
 public:
     SPMarker *_marker[SP_MARKER_LOC_QTY];
     sigc::connection _release_connect [SP_MARKER_LOC_QTY];
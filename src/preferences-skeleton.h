@@ -247,6 +247,11 @@ R"=====(
 
   <group id="options">
     <group id="renderingcache" size="512" />
+    <group id="exportstrips" value="4" />
+    <group id="imagecache" size="64" />
+    <group id="shell">
+      <group id="documentcache" value="16" />
+    </group>
     <group id="useoldpdfexporter" value="0" />
     <group id="highlightoriginal" value="1" />
     <group id="relinkclonesonduplicate" value="0" />
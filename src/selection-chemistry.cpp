@@ -1600,6 +1600,12 @@ void ObjectSet::applyAffine(Geom::Affine const &affine, bool set_i2d, bool compe
     if (isEmpty())
         return;
 
+    // "clones are unmoved when original is moved" preference
+    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+    int compensation = prefs->getInt("/options/clonecompensation/value", SP_CLONE_COMPENSATION_UNMOVED);
+    bool prefs_unmoved = (compensation == SP_CLONE_COMPENSATION_UNMOVED);
+    bool prefs_parallel = (compensation == SP_CLONE_COMPENSATION_PARALLEL);
+
     // For each perspective with a box in selection, check whether all boxes are selected and
     // unlink all non-selected boxes.
     Persp3D *persp;
@@ -1674,12 +1680,6 @@ void ObjectSet::applyAffine(Geom::Affine const &affine, bool set_i2d, bool compe
             }
         }
 
-        // "clones are unmoved when original is moved" preference
-        Inkscape::Preferences *prefs = Inkscape::Preferences::get();
-        int compensation = prefs->getInt("/options/clonecompensation/value", SP_CLONE_COMPENSATION_UNMOVED);
-        bool prefs_unmoved = (compensation == SP_CLONE_COMPENSATION_UNMOVED);
-        bool prefs_parallel = (compensation == SP_CLONE_COMPENSATION_PARALLEL);
-
         /* If this is a clone and it's selected along with its original, do not move it;
          * it will feel the transform of its original and respond to it itself.
          * Without this, a clone is doubly transformed, very unintuitive.
@@ -1785,6 +1785,9 @@ void ObjectSet::applyAffine(Geom::Affine const &affine, bool set_i2d, bool compe
             }
         }
     }
+
+    // the items are only modified on the next document update
+    _invalidateBounds();
 }
 
 void ObjectSet::removeTransform()
@@ -18,6 +18,7 @@
 #include <utility>
 
 #include <glibmm/i18n.h>
+#include <glibmm/main.h>
 
 #include "selection-describer.h"
 
@@ -35,41 +36,29 @@
 
 #include "xml/quote.h"
 
-// Returns a list of terms for the items to be used in the statusbar
-char* collect_terms (const std::vector<SPItem*> &items)
+// Returns a list of terms for the items to be used in the statusbar, and their number
+static char* collect_terms (const std::vector<SPItem*> &items, int &n_terms)
 {
+    // display names are mostly the same few static strings, so look at each one once
+    std::set<char const *> names;
     std::set<Glib::ustring> check;
     std::stringstream ss;
     bool first = true;
 
     for (auto item : items) {
-        if (item && item->displayName()) {
-            Glib::ustring term(item->displayName());
+        char const *name = item ? item->displayName() : nullptr;
+        if (name && names.insert(name).second) {
+            Glib::ustring term(name);
             if (term != "" && (check.insert(term).second)) {
                 ss << (first ? "" : ", ") << "<b>" << term.raw() << "</b>";
                 first = false;
             }
         }
     }
+    n_terms = check.size();
     return g_strdup(ss.str().c_str());
 }
 
-// Returns the number of terms in the list
-static int count_terms (const std::vector<SPItem*> &items)
-{
-    std::set<Glib::ustring> check;
-    int count=0;
-    for (auto item : items) {
-        if (item && item->displayName()) {
-            Glib::ustring term(item->displayName());
-            if (term != "" && (check.insert(term).second)) {
-                count++;
-            }
-        }
-    }
-    return count;
-}
-
 // Returns the number of filtered items in the list
 static int count_filtered (const std::vector<SPItem*> &items)
 {
@@ -92,7 +81,7 @@ SelectionDescriber::SelectionDescriber(Inkscape::Selection *selection, std::shar
 {
     _selection_changed_connection = new sigc::connection (
              selection->connectChanged(
-                 sigc::mem_fun(*this, &SelectionDescriber::_updateMessageFromSelection)));
+                 sigc::mem_fun(*this, &SelectionDescriber::_scheduleUpdate)));
     _updateMessageFromSelection(selection);
 }
 
@@ -100,6 +89,23 @@ SelectionDescriber::~SelectionDescriber()
 {
     _selection_changed_connection->disconnect();
     delete _selection_changed_connection;
+    _idle_connection.disconnect();
+}
+
+void SelectionDescriber::_scheduleUpdate(Inkscape::Selection *selection)
+{
+    // Describing a large selection walks all of it, so do it once after a burst of changes
+    _selection = selection;
+    if (!_idle_connection.connected()) {
+        _idle_connection = Glib::signal_idle().connect(
+            sigc::mem_fun(*this, &SelectionDescriber::_updateIdle), Glib::PRIORITY_DEFAULT_IDLE);
+    }
+}
+
+bool SelectionDescriber::_updateIdle()
+{
+    _updateMessageFromSelection(_selection);
+    return false;
 }
 
 void SelectionDescriber::_updateMessageFromSelection(Inkscape::Selection *selection) {
@@ -213,8 +219,8 @@ void SelectionDescriber::_updateMessageFromSelection(Inkscape::Selection *select
             g_free(item_desc);
         } else { // multiple items
             int objcount = items.size();
-            char *terms = collect_terms (items);
-            int n_terms = count_terms(items);
+            int n_terms = 0;
+            char *terms = collect_terms (items, n_terms);
             
             gchar *objects_str = g_strdup_printf(ngettext(
                 "<b>%1$i</b> objects selected of type %2$s",
@@ -29,8 +29,12 @@ public:
     ~SelectionDescriber();
 
 private:
+    void _scheduleUpdate(Inkscape::Selection *selection);
+    bool _updateIdle();
     void _updateMessageFromSelection(Inkscape::Selection *selection);
     sigc::connection *_selection_changed_connection;
+    sigc::connection _idle_connection;
+    Inkscape::Selection *_selection = nullptr;
 
     MessageContext _context;
 
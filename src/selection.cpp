@@ -63,6 +63,8 @@ Selection::~Selection() {
 /* Handler for selected objects "modified" signal */
 
 void Selection::_schedule_modified(SPObject */*obj*/, guint flags) {
+    _invalidateBounds();
+
     if (!this->_idle) {
         /* Request handling to be run in _idle loop */
         this->_idle = g_idle_add_full(SP_SELECTION_UPDATE_PRIORITY, GSourceFunc(&Selection::_emit_modified), this, nullptr);
@@ -155,10 +157,14 @@ SPObject *Selection::_objectForXMLNode(Inkscape::XML::Node *repr) const {
 
 size_t Selection::numberOfLayers() {
     auto items = this->items();
+    std::set<SPObject*> parents;
     std::set<SPObject*> layers;
     for (auto iter = items.begin(); iter != items.end(); ++iter) {
-        SPObject *layer = _layers->layerForObject(*iter);
-        layers.insert(layer);
+        // siblings are in the same layer
+        if (parents.insert((*iter)->parent).second) {
+            SPObject *layer = _layers->layerForObject(*iter);
+            layers.insert(layer);
+        }
     }
 
     return layers.size();
@@ -147,6 +147,13 @@ public:
      */
     std::vector<Inkscape::SnapCandidatePoint> getSnapPoints(SnapPreferences const *snapprefs) const;
 
+    /**
+     * Emits the modified signal from the idle loop, as for a modification of the selected
+     * objects. For changes made without an update of the document, e.g. items moved on the
+     * canvas only during a drag.
+     */
+    void scheduleModified(unsigned int flags) { _schedule_modified(nullptr, flags); }
+
     /**
      * Connects a slot to be notified of selection changes.
      *
@@ -208,6 +215,7 @@ protected:
     void _emitSignals() override;
     void _connectSignals(SPObject* object) override;
     void _releaseSignals(SPObject* object) override;
+    bool _tracksModification() const override { return true; }
 
 private:
     /** Issues modification notification signals. */
@@ -38,6 +38,7 @@
 #include "seltrans-handles.h"
 #include "verbs.h"
 
+#include "display/drawing-item.h"
 #include "display/snap-indicator.h"
 #include "display/sodipodi-ctrl.h"
 #include "display/sp-ctrlline.h"
@@ -56,6 +57,7 @@ using Inkscape::ControlManager;
 using Inkscape::DocumentUndo;
 
 static void sp_sel_trans_handle_grab(SPKnot *knot, guint state, SPSelTransHandle const* data);
+static bool is_referenced_recursive(SPObject *object);
 static void sp_sel_trans_handle_ungrab(SPKnot *knot, guint state, SPSelTransHandle const* data);
 static void sp_sel_trans_handle_click(SPKnot *knot, guint state, SPSelTransHandle const* data);
 static void sp_sel_trans_handle_new_event(SPKnot *knot, Geom::Point const &position, guint32 state, SPSelTransHandle const* data);
@@ -214,6 +216,8 @@ Inkscape::SelTrans::~SelTrans()
     _items_const.clear();
     _items_affines.clear();
     _items_centers.clear();
+    _items_preview.clear();
+    _items_dt2p.clear();
 }
 
 void Inkscape::SelTrans::resetState()
@@ -283,9 +287,16 @@ void Inkscape::SelTrans::grab(Geom::Point const &p, gdouble x, gdouble y, bool s
         _items_affines.push_back(it->i2dt_affine());
         _items_centers.push_back(it->getCenter()); // for content-dragging, we need to remember original centers
         SPLPEItem *lpeitem = dynamic_cast<SPLPEItem *>(it);
-        if (lpeitem && lpeitem->hasPathEffectRecursive()) {
+        bool const has_lpe = lpeitem && lpeitem->hasPathEffectRecursive();
+        if (has_lpe) {
             sp_lpe_item_update_patheffect(lpeitem, false, false);
         }
+        // Items that nothing else depends on can be previewed by moving their drawing items,
+        // which keeps their render caches; clones, text on path, connectors etc. of referenced
+        // items and path effects only follow when the object itself changes.
+        _items_preview.push_back(!SP_IS_ROOT(it) && !is_referenced_recursive(it) && !has_lpe);
+        _items_dt2p.push_back(it->parent ? SP_ITEM(it->parent)->i2dt_affine().inverse()
+                                         : it->document->dt2doc());
     }
 
     if (y != -1 && _desktop->is_yaxisdown()) {
@@ -397,6 +408,7 @@ void Inkscape::SelTrans::transform(Geom::Affine const &rel_affine, Geom::Point c
     Geom::Affine const affine( Geom::Translate(-norm) * rel_affine * Geom::Translate(norm) );
 
     if (_show == SHOW_CONTENT) {
+        bool previewed = false;
         // update the content
         for (unsigned i = 0; i < _items.size(); i++) {
             SPItem &item = *_items[i];
@@ -405,8 +417,25 @@ void Inkscape::SelTrans::transform(Geom::Affine const &rel_affine, Geom::Point c
                 break;
             }
             Geom::Affine const &prev_transform = _items_affines[i];
-            item.set_i2d_affine(prev_transform * affine);
-            // The new affine will only have been applied if the transformation is different from the previous one, see SPItem::set_item_transform
+            if (_items_preview[i]) {
+                // Only the drawing items are moved. The object takes the transform without an
+                // update, so that its bounds follow the drag and an update in the meantime keeps
+                // showing it; the update is requested once, in _commitPreview().
+                Geom::Affine const i2p = prev_transform * affine * _items_dt2p[i];
+                item.transform = i2p;
+                item.bbox_valid = FALSE;
+                for (SPItemView *v = item.display; v; v = v->next) {
+                    v->arenaitem->setTransform(i2p);
+                }
+                previewed = true;
+            } else {
+                item.set_i2d_affine(prev_transform * affine);
+                // The new affine will only have been applied if the transformation is different from the previous one, see SPItem::set_item_transform
+            }
+        }
+        if (previewed) {
+            // no update tells the selection, e.g. for the toolbar's X, Y, W and H
+            _desktop->getSelection()->scheduleModified(SP_OBJECT_MODIFIED_FLAG);
         }
     } else {
         if (_bbox) {
@@ -435,6 +464,7 @@ void Inkscape::SelTrans::ungrab()
     _desktop->snapindicator->remove_snapsource();
 
     Inkscape::Selection *selection = _desktop->getSelection();
+    _commitPreview();
     _updateVolatileState();
 
     for (auto & _item : _items) {
@@ -482,6 +512,8 @@ void Inkscape::SelTrans::ungrab()
         _items_const.clear();
         _items_affines.clear();
         _items_centers.clear();
+        _items_preview.clear();
+        _items_dt2p.clear();
 
         if (!_current_relative_affine.isIdentity()) { // we can have a identity affine
             // when trying to stretch a perfectly vertical line in horizontal direction, which will not be allowed
@@ -520,10 +552,37 @@ void Inkscape::SelTrans::ungrab()
         _items_const.clear();
         _items_affines.clear();
         _items_centers.clear();
+        _items_preview.clear();
+        _items_dt2p.clear();
         _updateHandles();
     }
 }
 
+/**
+ * Applies the transform previewed items were dragged to as live content dragging would have
+ * done, and brings the document up to date, so that their bounds can be read right away.
+ */
+void Inkscape::SelTrans::_commitPreview()
+{
+    if (_show != SHOW_CONTENT) {
+        return;
+    }
+    bool committed = false;
+    for (unsigned i = 0; i < _items_preview.size(); i++) {
+        if (_items_preview[i]) {
+            // back to the transform the item had before the drag, so that setting the dragged
+            // one requests the update
+            SPItem *item = _items[i];
+            item->transform = _items_affines[i] * _items_dt2p[i];
+            item->set_i2d_affine(_items_affines[i] * _current_relative_affine);
+            committed = true;
+        }
+    }
+    if (committed) {
+        _desktop->getDocument()->ensureUpToDate();
+    }
+}
+
 /* fixme: This is really bad, as we compare positions for each stamp (Lauris) */
 /* fixme: IMHO the best way to keep sort cache would be to implement timestamping at last */
 
@@ -537,6 +596,9 @@ void Inkscape::SelTrans::stamp()
         _stamp_cache.clear();
     }
 
+    // the copies take the transform of the originals
+    _commitPreview();
+
     /* stamping mode */
     if (!_empty) {
     	std::vector<SPItem*> l;
@@ -889,6 +951,23 @@ void Inkscape::SelTrans::_boundingBoxPrefsChanged(int prefs_bbox)
     _updateHandles();
 }
 
+/**
+ * Whether anything refers to the object or to one of its descendants, e.g. a clone or a
+ * text on path, which then has to be updated when the object moves.
+ */
+static bool is_referenced_recursive(SPObject *object)
+{
+    if (object->hrefcount > 0 || !object->hrefList.empty()) {
+        return true;
+    }
+    for (auto &child : object->children) {
+        if (is_referenced_recursive(&child)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /*
  * handlers for handle move-request
  */
@@ -122,6 +122,7 @@ private:
     Geom::Point _calcAbsAffineDefault(Geom::Scale const default_scale);
     Geom::Point _calcAbsAffineGeom(Geom::Scale const geom_scale);
     void _keepClosestPointOnly(Geom::Point const &p);
+    void _commitPreview();
 
     enum State {
         STATE_SCALE, //scale or stretch
@@ -135,6 +136,10 @@ private:
     std::vector<SPItem const *> _items_const;
     std::vector<Geom::Affine> _items_affines;
     std::vector<Geom::Point> _items_centers;
+    /// Items moved during a content drag by transforming their drawing items only,
+    /// with the desktop-to-parent transform to do so; see _commitPreview()
+    std::vector<bool> _items_preview;
+    std::vector<Geom::Affine> _items_dt2p;
 
     std::vector<Inkscape::SnapCandidatePoint> _snap_points;
     std::vector<Inkscape::SnapCandidatePoint> _bbox_points;
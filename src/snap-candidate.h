@@ -15,12 +15,18 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <2geom/affine.h>
+#include <2geom/pathvector.h>
 #include <2geom/point.h>
 #include <2geom/rect.h>
+#include <algorithm>
 #include <cstdio>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "snap-enums.h"
+#include "util/rtree.h"
 
 class SPItem; // forward declaration
 
@@ -128,15 +134,62 @@ public:
 }
 ;
 
+/**
+ * Geometry of a path to snap to, with an index of the bounding boxes of its curves. Shapes
+ * keep it between snapping runs, until their curve or transformation changes.
+ */
+class SnapTargetPath
+{
+public:
+    /**
+     * @param pathv The path, in document coordinates.
+     * @param transform The transformation that pathv has been obtained with.
+     */
+    SnapTargetPath(Geom::PathVector pathv, Geom::Affine const &transform = Geom::identity())
+        : _pathv(std::move(pathv)), _transform(transform)
+    {
+        std::vector<Util::RTree<std::pair<unsigned, unsigned>>::Entry> entries;
+        for (unsigned i = 0; i < _pathv.size(); ++i) {
+            for (unsigned j = 0; j < _pathv[i].size_default(); ++j) {
+                entries.emplace_back(_pathv[i][j].boundsFast(), std::make_pair(i, j));
+            }
+        }
+        _curves.build(std::move(entries));
+    }
+
+    Geom::PathVector const &pathv() const { return _pathv; }
+    Geom::Affine const &transform() const { return _transform; }
+
+    /**
+     * Returns the indices (path, curve) of the curves that might pass within distance of p,
+     * in the order of the path vector.
+     */
+    std::vector<std::pair<unsigned, unsigned>> curvesNear(Geom::Point const &p, Geom::Coord distance) const
+    {
+        std::vector<std::pair<unsigned, unsigned>> found;
+        Geom::Point const range(distance, distance);
+        _curves.search(Geom::Rect(p - range, p + range), [&](std::pair<unsigned, unsigned> const &curve) {
+            found.push_back(curve);
+        });
+        std::sort(found.begin(), found.end());
+        return found;
+    }
+
+private:
+    Geom::PathVector _pathv;
+    Geom::Affine _transform;
+    Util::RTree<std::pair<unsigned, unsigned>> _curves;
+};
+
 class SnapCandidatePath
 {
 
 public:
-    SnapCandidatePath(Geom::PathVector* path, SnapTargetType target, Geom::OptRect bbox, bool edited = false)
-        : path_vector(path), target_type(target), target_bbox(std::move(bbox)), currently_being_edited(edited) {};
+    SnapCandidatePath(std::shared_ptr<SnapTargetPath const> path, SnapTargetType target, Geom::OptRect bbox, bool edited = false)
+        : path(std::move(path)), target_type(target), target_bbox(std::move(bbox)), currently_being_edited(edited) {};
     ~SnapCandidatePath() = default;;
 
-    Geom::PathVector* path_vector;
+    std::shared_ptr<SnapTargetPath const> path;
     SnapTargetType target_type;
     Geom::OptRect target_bbox;
     bool currently_being_edited; // true for the path that's currently being edited in the node tool (if any)
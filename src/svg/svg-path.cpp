@@ -17,7 +17,9 @@
  */
 
 #include <cstring>
+#include <iterator>
 #include <string>
+#include <vector>
 #include <glib.h> // g_assert()
 
 #include <2geom/pathvector.h>
@@ -29,6 +31,49 @@
 #include "svg/svg.h"
 #include "svg/path-string.h"
 
+namespace {
+
+typedef std::vector<Geom::Path> PathSequence;
+typedef std::back_insert_iterator<PathSequence> PathSequenceInserter;
+
+/**
+ * Path sink handing each finished subpath over to the output sequence.
+ *
+ * Geom::PathBuilder copies the finished subpath to its output and then clear()s it, and
+ * since the curve data is still shared with the copy this duplicates every curve of the
+ * subpath before throwing them away. Here the sink starts over with a fresh path instead.
+ */
+class SubpathSink : public Geom::PathIteratorSink<PathSequenceInserter> {
+public:
+    SubpathSink(PathSequence &paths)
+        : Geom::PathIteratorSink<PathSequenceInserter>(PathSequenceInserter(paths))
+    {}
+
+    void flush() override {
+        if (_in_path) {
+            _in_path = false;
+            *_out++ = _path;
+            _path = Geom::Path();
+        }
+    }
+};
+
+/**
+ * Upper bound of the number of subpaths in path data: each one starts with a moveto.
+ */
+size_t count_subpaths(char const *str)
+{
+    size_t count = 0;
+    for (; *str; ++str) {
+        if (*str == 'M' || *str == 'm') {
+            ++count;
+        }
+    }
+    return count;
+}
+
+}
+
 /*
  * Parses the path in str. When an error is found in the pathstring, this method
  * returns a truncated path up to where the error was found in the pathstring.
@@ -36,24 +81,26 @@
  */
 Geom::PathVector sp_svg_read_pathv(char const * str)
 {
-    Geom::PathVector pathv;
     if (!str)
-        return pathv;  // return empty pathvector when str == NULL
+        return Geom::PathVector();  // return empty pathvector when str == NULL
+
+    PathSequence paths;
+    paths.reserve(count_subpaths(str));
 
-    Geom::PathBuilder builder(pathv);
-    Geom::SVGPathParser parser(builder);
+    SubpathSink sink(paths);
+    Geom::SVGPathParser parser(sink);
     parser.setZSnapThreshold(Geom::EPSILON);
 
     try {
         parser.parse(str);
     }
     catch (Geom::SVGPathParseError &e) {
-        builder.flush();
+        sink.flush();
         // This warning is extremely annoying when testing
         //g_warning("Malformed SVG path, truncated path up to where error was found.\n Input path=\"%s\"\n Parsed path=\"%s\"", str, sp_svg_write_path(pathv));
     }
 
-    return pathv;
+    return Geom::PathVector(paths.begin(), paths.end());
 }
 
 static void sp_svg_write_curve(Inkscape::SVG::PathString & str, Geom::Curve const * c) {
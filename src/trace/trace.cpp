@@ -337,6 +337,7 @@ Glib::RefPtr<Gdk::Pixbuf> Tracer::getSelectedImage()
     if (!img)
         return Glib::RefPtr<Gdk::Pixbuf>(nullptr);
 
+    img->ensurePixbuf();
     if (!img->pixbuf)
         return Glib::RefPtr<Gdk::Pixbuf>(nullptr);
 
@@ -423,6 +424,7 @@ void Tracer::traceThread()
         return;
         }
 
+    img->ensurePixbuf();
     GdkPixbuf *trace_pb = gdk_pixbuf_copy(img->pixbuf->getPixbufRaw(false));
     if (img->pixbuf->pixelFormat() == Inkscape::Pixbuf::PF_CAIRO) {
         convert_pixels_argb32_to_pixbuf(
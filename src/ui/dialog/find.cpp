@@ -13,6 +13,8 @@
 
 #include "find.h"
 
+#include <unordered_set>
+
 #include <gtkmm/entry.h>
 #include <glibmm/i18n.h>
 #include <glibmm/regex.h>
@@ -385,6 +387,20 @@ void Find::onSelectionChange()
 # FIND helper functions
 ########################################################################*/
 
+namespace {
+
+bool is_ascii(gchar const *str)
+{
+    for (; *str; ++str) {
+        if (static_cast<guchar>(*str) & 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
 Glib::ustring Find::find_replace(const gchar *str, const gchar *find, const gchar *replace, bool exact, bool casematch, bool replaceall)
 {
     Glib::ustring ustr = str;
@@ -429,6 +445,28 @@ gsize Find::find_strcmp_pos(const gchar *str, const gchar *find, bool exact, boo
 
 bool Find::find_strcmp(const gchar *str, const gchar *find, bool exact, bool casematch)
 {
+    if (str == nullptr) {
+        str = "";
+    }
+
+    // Compare the bytes in place where that gives the same answer as comparing lowercased
+    // Glib::ustrings, which is most of the time for ids, styles and attribute values.
+    if (casematch) {
+        return exact ? !strcmp(str, find) : strstr(str, find) != nullptr;
+    }
+    if (is_ascii(str) && is_ascii(find)) {
+        if (exact) {
+            return !g_ascii_strcasecmp(str, find);
+        }
+        size_t const len = strlen(find);
+        for (; *str; ++str) {
+            if (!g_ascii_strncasecmp(str, find, len)) {
+                return true;
+            }
+        }
+        return len == 0;
+    }
+
     return (std::string::npos != find_strcmp_pos(str, find, exact, casematch));
 }
 
@@ -463,7 +501,7 @@ bool Find::item_text_match (SPItem *item, const gchar *find, bool exact, bool ca
     }
 
     if (dynamic_cast<SPText *>(item) || dynamic_cast<SPFlowtext *>(item)) {
-        const gchar *item_text = sp_te_get_string_multiline (item);
+        gchar *item_text = sp_te_get_string_multiline (item);
         if (item_text == nullptr) {
             return false;
         }
@@ -477,6 +515,7 @@ bool Find::item_text_match (SPItem *item, const gchar *find, bool exact, bool ca
 
             Inkscape::Text::Layout const *layout = te_get_layout (item);
             if (!layout) {
+                free(item_text);
                 return found;
             }
 
@@ -488,6 +527,7 @@ bool Find::item_text_match (SPItem *item, const gchar *find, bool exact, bool ca
                 _begin_w = layout->charIndexToIterator(n);
                 _end_w = layout->charIndexToIterator(n + strlen(find));
                 sp_te_replace(item, _begin_w, _end_w, replace_text);
+                free(item_text);
                 item_text = sp_te_get_string_multiline (item);
                 n = find_strcmp_pos(item_text, ufind.c_str(), exact, casematch, n + strlen(replace_text) + 1);
             }
@@ -495,6 +535,7 @@ bool Find::item_text_match (SPItem *item, const gchar *find, bool exact, bool ca
             g_free(replace_text);
         }
 
+        free(item_text);
         return found;
     }
     return false;
@@ -536,7 +577,7 @@ bool Find::item_style_match (SPItem *item, const gchar *text, bool exact, bool c
         return false;
     }
 
-    gchar *item_style = g_strdup(item->getRepr()->attribute("style"));
+    const gchar *item_style = item->getRepr()->attribute("style");
     if (item_style == nullptr) {
         return false;
     }
@@ -552,7 +593,6 @@ bool Find::item_style_match (SPItem *item, const gchar *text, bool exact, bool c
         g_free(replace_text);
     }
 
-    g_free(item_style);
     return found;
 }
 
@@ -564,13 +604,11 @@ bool Find::item_attr_match(SPItem *item, const gchar *text, bool exact, bool /*c
         return false;
     }
 
-    gchar *attr_value = g_strdup(item->getRepr()->attribute(text));
     if (exact) {
-        found =  (attr_value != nullptr);
+        found =  (item->getRepr()->attribute(text) != nullptr);
     } else {
         found = item->getRepr()->matchAttributeName(text);
     }
-    g_free(attr_value);
 
     // TODO - Rename attribute name ?
     if (found && replace) {
@@ -590,22 +628,23 @@ bool Find::item_attrvalue_match(SPItem *item, const gchar *text, bool exact, boo
 
     Inkscape::Util::List<Inkscape::XML::AttributeRecord const> iter = item->getRepr()->attributeList();
     for (; iter; ++iter) {
-        const gchar* key = g_quark_to_string(iter->key);
-        gchar *attr_value = g_strdup(item->getRepr()->attribute(key));
-        bool found = find_strcmp(attr_value, text, exact, casematch);
+        // the value is read from the record, rather than looking the attribute up again
+        bool found = find_strcmp(iter->value.pointer(), text, exact, casematch);
         if (found) {
             ret = true;
         }
 
         if (found && replace) {
+            const gchar* key = g_quark_to_string(iter->key);
+            gchar *attr_value = g_strdup(iter->value.pointer());
             gchar * replace_text  = g_strdup(entry_replace.getEntry()->get_text().c_str());
             Glib::ustring new_item_style = find_replace(attr_value, text, replace_text , exact, casematch, true);
             if (new_item_style != attr_value) {
                 item->setAttribute(key, new_item_style);
             }
+            g_free(replace_text);
+            g_free(attr_value);
         }
-
-        g_free(attr_value);
     }
 
     return ret;
@@ -677,6 +716,7 @@ std::vector<SPItem*> Find::filter_fields (std::vector<SPItem*> &l, bool exact, b
 
     std::vector<SPItem*> in = l;
     std::vector<SPItem*> out;
+    std::unordered_set<SPItem*> found_items;
 
     if (check_searchin_text.get_active()) {
         for (std::vector<SPItem*>::const_reverse_iterator i=in.rbegin(); in.rend() != i; ++i) {
@@ -684,7 +724,7 @@ std::vector<SPItem*> Find::filter_fields (std::vector<SPItem*> &l, bool exact, b
             SPItem *item = dynamic_cast<SPItem *>(obj);
             g_assert(item != nullptr);
             if (item_text_match(item, text, exact, casematch)) {
-                if (out.end()==find(out.begin(),out.end(), *i)) {
+                if (found_items.insert(*i).second) {
                     out.push_back(*i);
                     if (_action_replace) {
                         item_text_match(item, text, exact, casematch, _action_replace);
@@ -708,7 +748,7 @@ std::vector<SPItem*> Find::filter_fields (std::vector<SPItem*> &l, bool exact, b
                 SPObject *obj = *i;
                 SPItem *item = dynamic_cast<SPItem *>(obj);
                 if (item_id_match(item, text, exact, casematch)) {
-                    if (out.end()==find(out.begin(),out.end(), *i)) {
+                    if (found_items.insert(*i).second) {
                         out.push_back(*i);
                         if (_action_replace) {
                             item_id_match(item, text, exact, casematch, _action_replace);
@@ -725,7 +765,7 @@ std::vector<SPItem*> Find::filter_fields (std::vector<SPItem*> &l, bool exact, b
                 SPItem *item = dynamic_cast<SPItem *>(obj);
                 g_assert(item != nullptr);
                 if (item_style_match(item, text, exact, casematch)) {
-                    if (out.end()==find(out.begin(),out.end(), *i)){
+                    if (found_items.insert(*i).second){
                             out.push_back(*i);
                             if (_action_replace) {
                                 item_style_match(item, text, exact, casematch, _action_replace);
@@ -742,7 +782,7 @@ std::vector<SPItem*> Find::filter_fields (std::vector<SPItem*> &l, bool exact, b
                 SPItem *item = dynamic_cast<SPItem *>(obj);
                 g_assert(item != nullptr);
                 if (item_attr_match(item, text, exact, casematch)) {
-                    if (out.end()==find(out.begin(),out.end(), *i)) {
+                    if (found_items.insert(*i).second) {
                         out.push_back(*i);
                         if (_action_replace) {
                             item_attr_match(item, text, exact, casematch, _action_replace);
@@ -759,7 +799,7 @@ std::vector<SPItem*> Find::filter_fields (std::vector<SPItem*> &l, bool exact, b
                 SPItem *item = dynamic_cast<SPItem *>(obj);
                 g_assert(item != nullptr);
                 if (item_attrvalue_match(item, text, exact, casematch)) {
-                    if (out.end()==find(out.begin(),out.end(), *i)) {
+                    if (found_items.insert(*i).second) {
                         out.push_back(*i);
                         if (_action_replace) {
                             item_attrvalue_match(item, text, exact, casematch, _action_replace);
@@ -776,7 +816,7 @@ std::vector<SPItem*> Find::filter_fields (std::vector<SPItem*> &l, bool exact, b
                 SPItem *item = dynamic_cast<SPItem *>(obj);
                 g_assert(item != nullptr);
                 if (item_font_match(item, text, exact, casematch)) {
-                    if (out.end()==find(out.begin(),out.end(),*i)) {
+                    if (found_items.insert(*i).second) {
                         out.push_back(*i);
                         if (_action_replace) {
                             item_font_match(item, text, exact, casematch, _action_replace);
@@ -791,7 +831,7 @@ std::vector<SPItem*> Find::filter_fields (std::vector<SPItem*> &l, bool exact, b
                 SPItem *item = dynamic_cast<SPItem *>(obj);
                 g_assert(item != nullptr);
                 if (item_desc_match(item, text, exact, casematch)) {
-                    if (out.end()==find(out.begin(),out.end(),*i)) {
+                    if (found_items.insert(*i).second) {
                         out.push_back(*i);
                         if (_action_replace) {
                             item_desc_match(item, text, exact, casematch, _action_replace);
@@ -806,7 +846,7 @@ std::vector<SPItem*> Find::filter_fields (std::vector<SPItem*> &l, bool exact, b
                 SPItem *item = dynamic_cast<SPItem *>(obj);
                 g_assert(item != nullptr);
                 if (item_title_match(item, text, exact, casematch)) {
-                    if (out.end()==find(out.begin(),out.end(),*i)) {
+                    if (found_items.insert(*i).second) {
                         out.push_back(*i);
                         if (_action_replace) {
                             item_title_match(item, text, exact, casematch, _action_replace);
@@ -887,7 +927,7 @@ std::vector<SPItem*> &Find::filter_list (std::vector<SPItem*> &l, bool exact, bo
     return l;
 }
 
-std::vector<SPItem*> &Find::all_items (SPObject *r, std::vector<SPItem*> &l, bool hidden, bool locked)
+std::deque<SPItem*> &Find::all_items (SPObject *r, std::deque<SPItem*> &l, bool hidden, bool locked)
 {
     if (dynamic_cast<SPDefs *>(r)) {
         return l; // we're not interested in items in defs
@@ -903,7 +943,7 @@ std::vector<SPItem*> &Find::all_items (SPObject *r, std::vector<SPItem*> &l, boo
         SPItem *item = dynamic_cast<SPItem *>(&child);
         if (item && !child.cloned && !desktop->isLayer(item)) {
             if ((hidden || !desktop->itemIsHidden(item)) && (locked || !item->isLocked())) {
-                l.insert(l.begin(),(SPItem*)&child);
+                l.push_front((SPItem*)&child);
             }
         }
         l = all_items (&child, l, hidden, locked);
@@ -911,7 +951,7 @@ std::vector<SPItem*> &Find::all_items (SPObject *r, std::vector<SPItem*> &l, boo
     return l;
 }
 
-std::vector<SPItem*> &Find::all_selection_items (Inkscape::Selection *s, std::vector<SPItem*> &l, SPObject *ancestor, bool hidden, bool locked)
+std::deque<SPItem*> &Find::all_selection_items (Inkscape::Selection *s, std::deque<SPItem*> &l, SPObject *ancestor, bool hidden, bool locked)
 {
     auto desktop = getDesktop();
 
@@ -972,20 +1012,21 @@ void Find::onAction()
     bool casematch = check_case_sensitive.get_active();
     blocked = true;
 
-    std::vector<SPItem*> l;
+    std::deque<SPItem*> items;
     if (check_scope_selection.get_active()) {
         if (check_scope_layer.get_active()) {
-            l = all_selection_items (desktop->selection, l, desktop->currentLayer(), hidden, locked);
+            all_selection_items (desktop->selection, items, desktop->currentLayer(), hidden, locked);
         } else {
-            l = all_selection_items (desktop->selection, l, nullptr, hidden, locked);
+            all_selection_items (desktop->selection, items, nullptr, hidden, locked);
         }
     } else {
         if (check_scope_layer.get_active()) {
-            l = all_items (desktop->currentLayer(), l, hidden, locked);
+            all_items (desktop->currentLayer(), items, hidden, locked);
         } else {
-            l = all_items(desktop->getDocument()->getRoot(), l, hidden, locked);
+            all_items(desktop->getDocument()->getRoot(), items, hidden, locked);
         }
     }
+    std::vector<SPItem*> l(items.begin(), items.end());
     guint all = l.size();
 
     std::vector<SPItem*> n = filter_list (l, exact, casematch);
@@ -1010,7 +1051,6 @@ void Find::onAction()
         }
 
         Inkscape::Selection *selection = desktop->getSelection();
-        selection->clear();
         selection->setList(n);
         SPObject *obj = n[0];
         SPItem *item = dynamic_cast<SPItem *>(obj);
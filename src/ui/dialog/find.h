@@ -17,6 +17,8 @@
 #include "ui/widget/entry.h"
 #include "ui/widget/frame.h"
 
+#include <deque>
+
 #include <gtkmm/box.h>
 #include <gtkmm/buttonbox.h>
 #include <gtkmm/expander.h>
@@ -182,12 +184,12 @@ protected:
      * recursive function to return a list of all the items in the SPObject tree
      *
      */
-    std::vector<SPItem*> &    all_items (SPObject *r, std::vector<SPItem*> &l, bool hidden, bool locked);
+    std::deque<SPItem*> &     all_items (SPObject *r, std::deque<SPItem*> &l, bool hidden, bool locked);
     /**
      * to return a list of all the selected items
      *
      */
-    std::vector<SPItem*> &    all_selection_items (Inkscape::Selection *s, std::vector<SPItem*> &l, SPObject *ancestor, bool hidden, bool locked);
+    std::deque<SPItem*> &     all_selection_items (Inkscape::Selection *s, std::deque<SPItem*> &l, SPObject *ancestor, bool hidden, bool locked);
 
     /**
      * Shrink the dialog size when the expander widget is closed
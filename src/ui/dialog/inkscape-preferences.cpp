@@ -2541,6 +2541,9 @@ void InkscapePreferences::initPageSystem()
     _misc_latency_skew.init("/debug/latency/skew", 0.5, 2.0, 0.01, 0.10, 1.0, false, false);
     _page_system.add_line( false, _("Latency _skew:"), _misc_latency_skew, _("(requires restart)"),
                            _("Factor by which the event clock is skewed from the actual time (0.9766 on some systems)"), false);
+    _misc_undo_memory.init("/options/undo/memory", 0.0, 16384.0, 1.0, 64.0, 256.0, true, false);
+    _page_system.add_line( false, _("_Undo history memory:"), _misc_undo_memory, C_("mebibyte (2^20 bytes) abbreviation","MiB"),
+                           _("Set the amount of memory per document which can be used to keep undo history; the oldest steps are dropped when it is used up. Set to zero for no limit"), false);
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
     _misc_namedicon_delay.init( _("Pre-render named icons"), "/options/iconrender/named_nodelay", false);
     _page_system.add_line( false, "", _misc_namedicon_delay, "",
@@ -362,6 +362,7 @@ protected:
     // System page
     // Gtk::Button         *_apply_theme;
     UI::Widget::PrefSpinButton  _misc_latency_skew;
+    UI::Widget::PrefSpinButton  _misc_undo_memory;
     UI::Widget::PrefSpinButton  _misc_simpl;
     Gtk::Entry                  _sys_user_prefs;
     Gtk::Entry                  _sys_tmp_files;
@@ -67,6 +67,14 @@ public:
 	 */
 	virtual void notifyClearRedoEvent() = 0;
 
+	/**
+	 * Triggered when the oldest event is dropped from the undo log to stay
+	 * within the memory budget.
+	 *
+	 * \param log Pointer to the Event about to be deleted.
+	 */
+	virtual void notifyUndoExpiredEvent(Event* log) = 0;
+
 };
 
 }
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Static R-tree for rectangle queries
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_UTIL_RTREE_H
+#define SEEN_INKSCAPE_UTIL_RTREE_H
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <2geom/rect.h>
+
+namespace Inkscape {
+namespace Util {
+
+/**
+ * R-tree of values with bounding boxes, for finding all values whose box
+ * intersects a rectangle or contains a point.
+ *
+ * The tree is bulk loaded with the Sort-Tile-Recursive method and is not
+ * modified afterwards: call build() again when the set of values changes.
+ * Queries take O(log n + k) time for k results, instead of testing every box.
+ */
+template <typename T>
+class RTree {
+public:
+    typedef std::pair<Geom::Rect, T> Entry;
+
+    RTree() = default;
+
+    /// Replaces the contents of the tree.
+    void build(std::vector<Entry> entries)
+    {
+        _levels.clear();
+        _entries = std::move(entries);
+        if (_entries.empty()) {
+            return;
+        }
+
+        // Sort-Tile-Recursive: cut into vertical slices by x, then fill
+        // the leaves slice by slice in y order.
+        std::size_t const leaf_count = (_entries.size() + FANOUT - 1) / FANOUT;
+        std::size_t const slice_count = std::ceil(std::sqrt(static_cast<double>(leaf_count)));
+        std::size_t const slice_size = slice_count * FANOUT;
+
+        std::sort(_entries.begin(), _entries.end(), [](Entry const &a, Entry const &b) {
+            return a.first.midpoint()[Geom::X] < b.first.midpoint()[Geom::X];
+        });
+        for (std::size_t i = 0; i < _entries.size(); i += slice_size) {
+            auto slice_end = _entries.begin() + std::min(i + slice_size, _entries.size());
+            std::sort(_entries.begin() + i, slice_end, [](Entry const &a, Entry const &b) {
+                return a.first.midpoint()[Geom::Y] < b.first.midpoint()[Geom::Y];
+            });
+        }
+
+        // Each level holds the bounds of groups of FANOUT consecutive boxes of the one below.
+        std::vector<Geom::Rect> below;
+        below.reserve(_entries.size());
+        for (auto const &entry : _entries) {
+            below.push_back(entry.first);
+        }
+        while (below.size() > 1) {
+            std::vector<Geom::Rect> level;
+            level.reserve((below.size() + FANOUT - 1) / FANOUT);
+            for (std::size_t i = 0; i < below.size(); i += FANOUT) {
+                Geom::Rect box = below[i];
+                for (std::size_t j = i + 1; j < std::min(i + FANOUT, below.size()); ++j) {
+                    box.unionWith(below[j]);
+                }
+                level.push_back(box);
+            }
+            _levels.push_back(std::move(level));
+            below = _levels.back();
+        }
+    }
+
+    void clear()
+    {
+        _entries.clear();
+        _levels.clear();
+    }
+
+    bool empty() const { return _entries.empty(); }
+    std::size_t size() const { return _entries.size(); }
+
+    /**
+     * Calls @a f with every value whose box intersects @a area, in no particular order.
+     */
+    template <typename F>
+    void search(Geom::Rect const &area, F &&f) const
+    {
+        if (_entries.empty()) {
+            return;
+        }
+        if (_levels.empty()) {
+            if (_entries.front().first.intersects(area)) {
+                f(_entries.front().second);
+            }
+            return;
+        }
+        _search(_levels.size() - 1, 0, area, f);
+    }
+
+    /**
+     * Calls @a f with every value whose box contains @a p, in no particular order.
+     */
+    template <typename F>
+    void search(Geom::Point const &p, F &&f) const
+    {
+        search(Geom::Rect(p, p), std::forward<F>(f));
+    }
+
+private:
+    static std::size_t const FANOUT = 16;
+
+    template <typename F>
+    void _search(std::size_t level, std::size_t node, Geom::Rect const &area, F &f) const
+    {
+        std::size_t const first = node * FANOUT;
+        if (level == 0) {
+            std::size_t const last = std::min(first + FANOUT, _entries.size());
+            for (std::size_t i = first; i < last; ++i) {
+                if (_entries[i].first.intersects(area)) {
+                    f(_entries[i].second);
+                }
+            }
+        } else {
+            std::vector<Geom::Rect> const &below = _levels[level - 1];
+            std::size_t const last = std::min(first + FANOUT, below.size());
+            for (std::size_t i = first; i < last; ++i) {
+                if (below[i].intersects(area)) {
+                    _search(level - 1, i, area, f);
+                }
+            }
+        }
+    }
+
+    std::vector<Entry> _entries;
+    /// Bounds of the tree nodes; the first level groups the entries, the last one is the root
+    std::vector<std::vector<Geom::Rect>> _levels;
+};
+
+} // namespace Util
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_UTIL_RTREE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
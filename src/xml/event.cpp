@@ -16,6 +16,8 @@
 
 #include <glib.h> // g_assert()
 #include <cstdio>
+#include <cstring>
+#include <map>
 
 #include "event.h"
 #include "event-fns.h"
@@ -293,6 +295,67 @@ sp_repr_free_log (Inkscape::XML::Event *log)
     }
 }
 
+Inkscape::XML::Event *
+sp_repr_compact_log (Inkscape::XML::Event *log)
+{
+    using Inkscape::XML::EventChgAttr;
+
+    /* fold all changes of an attribute into the latest one, not just
+     * consecutive ones; attribute values do not depend on other events */
+    std::map<std::pair<Inkscape::XML::Node *, GQuark>, EventChgAttr *> latest;
+
+    Inkscape::XML::Event **prev_ptr = &log;
+    while (Inkscape::XML::Event *action = *prev_ptr) {
+        auto chg_attr = dynamic_cast<EventChgAttr *>(action);
+        if (chg_attr) {
+            auto found = latest.emplace(std::make_pair(chg_attr->repr, chg_attr->key), chg_attr);
+            if (!found.second && found.first->second->absorb(*chg_attr)) {
+                *prev_ptr = action->next;
+                delete action;
+                continue;
+            }
+        }
+        prev_ptr = &action->next;
+    }
+
+    return log;
+}
+
+std::size_t
+sp_repr_log_memory (Inkscape::XML::Event const *log)
+{
+    std::size_t size = 0;
+    for (Inkscape::XML::Event const *action = log; action; action = action->next) {
+        if (auto chg_attr = dynamic_cast<Inkscape::XML::EventChgAttr const *>(action)) {
+            size += chg_attr->memoryUsage();
+        } else if (auto chg_content = dynamic_cast<Inkscape::XML::EventChgContent const *>(action)) {
+            size += sizeof(*chg_content);
+            size += chg_content->oldval ? std::strlen(chg_content->oldval) + 1 : 0;
+            size += chg_content->newval ? std::strlen(chg_content->newval) + 1 : 0;
+        } else {
+            size += sizeof(Inkscape::XML::EventChgOrder);
+        }
+    }
+    return size;
+}
+
+bool Inkscape::XML::EventChgAttr::absorb(Inkscape::XML::EventChgAttr const &prior)
+{
+    if (prior.repr != this->repr || prior.key != this->key) {
+        return false;
+    }
+    this->oldval = prior.oldval;
+    return true;
+}
+
+std::size_t Inkscape::XML::EventChgAttr::memoryUsage() const
+{
+    std::size_t size = sizeof(*this);
+    size += this->oldval ? std::strlen(this->oldval) + 1 : 0;
+    size += this->newval ? std::strlen(this->newval) + 1 : 0;
+    return size;
+}
+
 namespace {
 
 template <typename T> struct ActionRelations;
@@ -346,12 +409,8 @@ Inkscape::XML::Event *Inkscape::XML::EventChgAttr::_optimizeOne() {
 
     /* consecutive chgattrs on the same key can be combined */
     if ( chg_attr) {
-        if ( chg_attr->repr == this->repr &&
-             chg_attr->key == this->key )
-        {
-            /* replace our oldval with the prior action's */
-            this->oldval = chg_attr->oldval;
-
+        /* take over the prior action's oldval */
+        if (this->absorb(*chg_attr)) {
             /* discard the prior action */
             this->next = chg_attr->next;
             delete chg_attr;
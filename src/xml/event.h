@@ -175,6 +175,16 @@ public:
     /// Value of the attribute after the change
     Inkscape::Util::ptr_shared newval;
 
+    /**
+     * @brief Fold an earlier change of the same attribute into this one
+     *
+     * Afterwards this event undoes both changes and @a prior can be discarded.
+     * Returns false, leaving both unchanged, if @a prior changed another attribute.
+     */
+    bool absorb(EventChgAttr const &prior);
+    /// Approximate memory held by the event
+    std::size_t memoryUsage() const;
+
 private:
     Event *_optimizeOne() override;
     void _undoOne(NodeObserver &observer) const override;
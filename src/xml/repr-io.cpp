@@ -656,12 +656,12 @@ static void sp_repr_save_writer(Document *doc, Inkscape::IO::Writer *out,
 }
 
 
-Glib::ustring sp_repr_save_buf(Document *doc)
+Glib::ustring sp_repr_save_buf(Document *doc, gchar const *default_ns)
 {   
     Inkscape::IO::StringOutputStream souts;
     Inkscape::IO::OutputStreamWriter outs(souts);
 
-    sp_repr_save_writer(doc, &outs, SP_INKSCAPE_NS_URI, nullptr, nullptr);
+    sp_repr_save_writer(doc, &outs, default_ns, nullptr, nullptr);
 
     outs.close();
     Glib::ustring buf = souts.getString();
@@ -759,15 +759,22 @@ bool sp_repr_save_file(Document *doc, gchar const *const filename, gchar const *
 static void repr_quote_write (Writer &out, const gchar * val)
 {
     if (val) {
+        // Copy runs of characters that need no escaping in one go
+        const gchar *run = val;
         for (; *val != '\0'; val++) {
+            const gchar *entity = nullptr;
             switch (*val) {
-                case '"': out.writeString( "&quot;" ); break;
-                case '&': out.writeString( "&amp;" ); break;
-                case '<': out.writeString( "&lt;" ); break;
-                case '>': out.writeString( "&gt;" ); break;
-                default: out.writeChar( *val ); break;
+                case '"': entity = "&quot;"; break;
+                case '&': entity = "&amp;"; break;
+                case '<': entity = "&lt;"; break;
+                case '>': entity = "&gt;"; break;
+                default: continue;
             }
+            out.write(run, val - run);
+            out.writeString(entity);
+            run = val + 1;
         }
+        out.write(run, val - run);
     }
 }
 
@@ -987,7 +994,8 @@ void sp_repr_write_stream_element( Node * repr, Writer & out,
     } else {
         element_name = g_quark_to_string(code);
     }
-    out.printf( "<%s", element_name );
+    out.writeChar('<');
+    out.writeString(element_name);
 
     // If this is a <text> element, suppress formatting whitespace
     // for its content and children:
@@ -1018,7 +1026,9 @@ void sp_repr_write_stream_element( Node * repr, Writer & out,
                 }
             }
         }
-        out.printf(" %s=\"", g_quark_to_string(iter->key));
+        out.writeChar(' ');
+        out.writeString(g_quark_to_string(iter->key));
+        out.writeString("=\"");
         repr_quote_write(out, iter->value);
         out.writeChar('"');
     }
@@ -1049,7 +1059,9 @@ void sp_repr_write_stream_element( Node * repr, Writer & out,
                 }
             }
         }
-        out.printf( "</%s>", element_name );
+        out.writeString("</");
+        out.writeString(element_name);
+        out.writeChar('>');
     } else {
         out.writeString( " />" );
     }
@@ -60,7 +60,7 @@ void sp_repr_write_stream(Inkscape::XML::Node *repr, Inkscape::IO::Writer &out,
                           char const *old_href_base = nullptr,
                           char const *new_href_base = nullptr);
 Inkscape::XML::Document *sp_repr_read_buf (const Glib::ustring &buf, const char *default_ns);
-Glib::ustring sp_repr_save_buf(Inkscape::XML::Document *doc);
+Glib::ustring sp_repr_save_buf(Inkscape::XML::Document *doc, char const *default_ns = SP_INKSCAPE_NS_URI);
 
 // TODO convert to std::string
 void sp_repr_save_stream(Inkscape::XML::Document *doc, FILE *to_file,
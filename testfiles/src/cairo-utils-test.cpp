@@ -10,8 +10,10 @@
  */
 
 #include <gtest/gtest.h>
+#include <glib/gstdio.h>
 #include <src/display/cairo-utils.h>
 #include <src/inkscape.h>
+#include <src/preferences.h>
 
 
 class PixbufTest : public ::testing::Test {
@@ -24,12 +26,46 @@ class PixbufTest : public ::testing::Test {
         return r;
     }
 
+    /// Writes a transparent PNG of the given size
+    static void write_png(std::string const &fn, int width, int height)
+    {
+        cairo_surface_t *s = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        ASSERT_EQ(cairo_surface_write_to_png(s, fn.c_str()), CAIRO_STATUS_SUCCESS);
+        cairo_surface_destroy(s);
+    }
+
+    static std::string read_file(std::string const &fn)
+    {
+        gchar *contents = nullptr;
+        gsize length = 0;
+        g_file_get_contents(fn.c_str(), &contents, &length, nullptr);
+        std::string r(contents ? contents : "", length);
+        g_free(contents);
+        return r;
+    }
+
   protected:
     void SetUp() override
     {
         // setup hidden dependency
         Inkscape::Application::create(false);
+
+        dir = g_dir_make_tmp("cairo-utils-test-XXXXXX", nullptr);
+        ASSERT_NE(dir, nullptr);
+        png = std::string(dir) + G_DIR_SEPARATOR_S + "image.png";
+    }
+
+    void TearDown() override
+    {
+        Inkscape::Preferences::get()->remove("/options/imagecache/size");
+        g_remove((png + ".new").c_str());
+        g_remove(png.c_str());
+        g_rmdir(dir);
+        g_free(dir);
     }
+
+    gchar *dir = nullptr;
+    std::string png;
 };
 
 TEST_F(PixbufTest, creatingFromSvgBufferWithoutViewboxOrWidthAndHeightReturnsNull)
@@ -48,4 +84,110 @@ TEST_F(PixbufTest, creatingFromSvgUriWithoutViewboxOrWidthAndHeightReturnsNull)
     double default_dpi = 96.0;
 
     ASSERT_EQ(Inkscape::Pixbuf::create_from_data_uri(uri_data.c_str(), default_dpi), nullptr);
-}
\ No newline at end of file
+}
+
+TEST_F(PixbufTest, sameDataUriIsDecodedOnce)
+{
+    write_png(png, 3, 2);
+    std::string uri_data = "image/png;base64," + base64of(read_file(png));
+
+    std::shared_ptr<Inkscape::Pixbuf> first = Inkscape::Pixbuf::get_from_data_uri(uri_data.c_str(), 96.0);
+    std::shared_ptr<Inkscape::Pixbuf> second = Inkscape::Pixbuf::get_from_data_uri(uri_data.c_str(), 96.0);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(first->width(), 3);
+    EXPECT_EQ(first->height(), 2);
+}
+
+TEST_F(PixbufTest, sameFileIsDecodedOnce)
+{
+    write_png(png, 3, 2);
+    std::shared_ptr<Inkscape::Pixbuf> first = Inkscape::Pixbuf::get_from_file(png, 96.0);
+    std::shared_ptr<Inkscape::Pixbuf> second = Inkscape::Pixbuf::get_from_file(png, 96.0);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first, second);
+}
+
+TEST_F(PixbufTest, replacedFileIsDecodedAgain)
+{
+    write_png(png, 3, 2);
+    std::shared_ptr<Inkscape::Pixbuf> before = Inkscape::Pixbuf::get_from_file(png, 96.0);
+    ASSERT_NE(before, nullptr);
+
+    // replace the file as editors do, by renaming a new one over it
+    write_png(png + ".new", 5, 4);
+    ASSERT_EQ(g_rename((png + ".new").c_str(), png.c_str()), 0);
+
+    std::shared_ptr<Inkscape::Pixbuf> after = Inkscape::Pixbuf::get_from_file(png, 96.0);
+    ASSERT_NE(after, nullptr);
+    EXPECT_NE(before, after);
+    EXPECT_EQ(after->width(), 5);
+    EXPECT_EQ(after->height(), 4);
+}
+
+TEST_F(PixbufTest, missingFileIsNotCached)
+{
+    EXPECT_EQ(Inkscape::Pixbuf::get_from_file(png, 96.0), nullptr);
+    write_png(png, 3, 2);
+    EXPECT_NE(Inkscape::Pixbuf::get_from_file(png, 96.0), nullptr);
+}
+
+TEST_F(PixbufTest, recentlyUsedImagesAreKept)
+{
+    write_png(png, 3, 2);
+    std::weak_ptr<Inkscape::Pixbuf> released = Inkscape::Pixbuf::get_from_file(png, 96.0);
+    EXPECT_FALSE(released.expired());
+}
+
+TEST_F(PixbufTest, imagesOverBudgetAreReleased)
+{
+    Inkscape::Preferences::get()->setInt("/options/imagecache/size", 0);
+    write_png(png, 3, 2);
+    std::weak_ptr<Inkscape::Pixbuf> released = Inkscape::Pixbuf::get_from_file(png, 96.0);
+    EXPECT_TRUE(released.expired());
+}
+
+TEST_F(PixbufTest, asyncDecodeIsShared)
+{
+    write_png(png, 3, 2);
+    std::shared_ptr<Inkscape::PendingPixbuf> pending = Inkscape::Pixbuf::get_from_file_async(png, 96.0);
+    ASSERT_NE(pending, nullptr);
+    // the size is known before the image is decoded
+    EXPECT_EQ(pending->width(), 3);
+    EXPECT_EQ(pending->height(), 2);
+    EXPECT_EQ(Inkscape::Pixbuf::get_from_file_async(png, 96.0), pending);
+
+    std::shared_ptr<Inkscape::Pixbuf> pb = pending->wait();
+    ASSERT_NE(pb, nullptr);
+    EXPECT_TRUE(pending->done());
+    EXPECT_EQ(pb->width(), 3);
+    EXPECT_EQ(Inkscape::Pixbuf::get_from_file(png, 96.0), pb);
+}
+
+TEST_F(PixbufTest, asyncDecodeSignalsFromMainLoop)
+{
+    write_png(png, 3, 2);
+    std::shared_ptr<Inkscape::PendingPixbuf> pending = Inkscape::Pixbuf::get_from_file_async(png, 96.0);
+    ASSERT_NE(pending, nullptr);
+
+    bool emitted = false;
+    pending->signal_done.connect([&emitted] { emitted = true; });
+    gint64 const deadline = g_get_monotonic_time() + 10 * G_USEC_PER_SEC;
+    while (!emitted && g_get_monotonic_time() < deadline) {
+        if (!g_main_context_iteration(nullptr, FALSE)) {
+            g_usleep(1000);
+        }
+    }
+    ASSERT_TRUE(emitted);
+    EXPECT_TRUE(pending->done());
+    EXPECT_EQ(pending->wait(), Inkscape::Pixbuf::get_from_file(png, 96.0));
+}
+
+TEST_F(PixbufTest, asyncDecodeIsOnlyForRasterImages)
+{
+    std::string const svg = std::string(dir) + G_DIR_SEPARATOR_S + "image.svg";
+    std::string const svg_buffer("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"3\" height=\"2\"/>");
+    ASSERT_TRUE(g_file_set_contents(svg.c_str(), svg_buffer.c_str(), svg_buffer.size(), nullptr));
+    EXPECT_EQ(Inkscape::Pixbuf::get_from_file_async(svg, 96.0), nullptr);
+    g_remove(svg.c_str());
+}
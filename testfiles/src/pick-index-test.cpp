@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Test picking paths through PathvPickIndex
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <2geom/path.h>
+#include <2geom/pathvector.h>
+#include <2geom/transforms.h>
+
+#include "helper/geom.h"
+
+namespace {
+
+// A wavy closed outline with many curves, plus an open subpath and a hole
+Geom::PathVector sample_path(int curves)
+{
+    Geom::PathVector pv;
+
+    Geom::Path outline(Geom::Point(200, 100));
+    for (int i = 1; i <= curves; ++i) {
+        double const a = 2 * M_PI * i / curves;
+        double const r = 100 + 20 * std::sin(7 * a);
+        Geom::Point const end(100 + r * std::cos(a), 100 + r * std::sin(a));
+        Geom::Point const mid = Geom::middle_point(outline.finalPoint(), end);
+        outline.appendNew<Geom::CubicBezier>(mid + Geom::Point(3, -3), mid + Geom::Point(-3, 3), end);
+    }
+    outline.close();
+    pv.push_back(outline);
+
+    Geom::Path hole(Geom::Point(80, 80));
+    hole.appendNew<Geom::LineSegment>(Geom::Point(120, 80));
+    hole.appendNew<Geom::LineSegment>(Geom::Point(120, 120));
+    hole.appendNew<Geom::LineSegment>(Geom::Point(80, 120));
+    hole.close();
+    pv.push_back(hole);
+
+    Geom::Path open(Geom::Point(140, 140));
+    open.appendNew<Geom::LineSegment>(Geom::Point(170, 140));
+    open.appendNew<Geom::LineSegment>(Geom::Point(170, 170));
+    pv.push_back(open);
+
+    return pv;
+}
+
+}
+
+TEST(PickIndexTest, MatchesFullScan)
+{
+    Geom::PathVector const pv = sample_path(200);
+    Geom::Affine const m = Geom::Scale(1.5) * Geom::Rotate(0.3) * Geom::Translate(10, 20);
+    PathvPickIndex const index(pv, m);
+    double const radius = 2.0;
+
+    for (double x = -60; x < 300; x += 3.7) {
+        for (double y = -60; y < 300; y += 3.7) {
+            Geom::Point const p(x, y);
+            int wind = 0;
+            double dist = Geom::infinity();
+            pathv_matrix_point_bbox_wind_distance(pv, m, p, nullptr, &wind, &dist, 0.5, nullptr);
+
+            int index_wind = 0;
+            double index_dist = radius;
+            index.windDistance(p, &index_wind, &index_dist, 0.5);
+
+            // both approximate curves near the point, so only compare away from the edges
+            if (std::abs(dist - radius) > 0.5) {
+                EXPECT_EQ(dist < radius, index_dist < radius) << x << "," << y;
+            }
+            if (dist > 3) {
+                EXPECT_EQ(wind, index_wind) << x << "," << y;
+            }
+        }
+    }
+}
+
+TEST(PickIndexTest, StrokeIgnoresClosingLines)
+{
+    Geom::PathVector const pv = sample_path(10);
+    PathvPickIndex const index(pv, Geom::identity());
+
+    // on the line that would close the open subpath
+    double dist = 1.0;
+    index.windDistance(Geom::Point(155, 155), nullptr, &dist, 0.5);
+    EXPECT_EQ(dist, 1.0);
+
+    int wind = 0;
+    index.windDistance(Geom::Point(155, 155), &wind, &dist, 0.5);
+    EXPECT_LT(dist, 1.0);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
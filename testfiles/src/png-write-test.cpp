@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Test PNG export through sp_export_png_file()
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib/gstdio.h>
+
+#include <2geom/rect.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "preferences.h"
+
+#include "helper/png-write.h"
+#include "object/sp-item.h"
+
+namespace {
+
+// Four bands of 250 rows each, so that the export is written in many strips
+char const *const bands_svg = R"A(
+<svg xmlns="http://www.w3.org/2000/svg" width="10" height="1000" viewBox="0 0 10 1000">
+  <rect id="red" x="0" y="0" width="10" height="250" fill="#ff0000"/>
+  <rect id="green" x="0" y="250" width="10" height="250" fill="#00ff00"/>
+  <rect id="blue" x="0" y="500" width="10" height="250" fill="#0000ff"/>
+  <rect id="grey" x="0" y="750" width="10" height="250" fill="#808080"/>
+</svg>)A";
+
+guint32 pixel_at(GdkPixbuf *pb, int x, int y)
+{
+    guchar const *p = gdk_pixbuf_get_pixels(pb) + y * gdk_pixbuf_get_rowstride(pb)
+                      + x * gdk_pixbuf_get_n_channels(pb);
+    return ((guint32) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+}
+
+class PngWriteTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        Inkscape::Application::create(false);
+        doc = SPDocument::createNewDocFromMem(bands_svg, static_cast<int>(strlen(bands_svg)), false);
+        ASSERT_NE(doc, nullptr);
+        doc->ensureUpToDate();
+
+        dir = g_dir_make_tmp("png-write-test-XXXXXX", nullptr);
+        ASSERT_NE(dir, nullptr);
+        filename = std::string(dir) + G_DIR_SEPARATOR_S + "out.png";
+    }
+
+    void TearDown() override
+    {
+        Inkscape::Preferences::get()->remove("/options/exportstrips/value");
+        g_remove(filename.c_str());
+        g_rmdir(dir);
+        g_free(dir);
+        delete doc;
+    }
+
+    void expectBands(unsigned long width, unsigned long height)
+    {
+        GdkPixbuf *pb = gdk_pixbuf_new_from_file(filename.c_str(), nullptr);
+        ASSERT_NE(pb, nullptr);
+        ASSERT_EQ(gdk_pixbuf_get_width(pb), (int) width);
+        ASSERT_EQ(gdk_pixbuf_get_height(pb), (int) height);
+
+        guint32 const colors[] = { 0xff0000ff, 0x00ff00ff, 0x0000ffff, 0x808080ff };
+        for (unsigned long y = 0; y < height; ++y) {
+            // skip the antialiased rows where two bands meet
+            unsigned long band = 4 * y / height;
+            if (4 * y % height == 0 || 4 * (y + 1) % height == 0) {
+                continue;
+            }
+            EXPECT_EQ(pixel_at(pb, 0, y), colors[band]) << "row " << y;
+            EXPECT_EQ(pixel_at(pb, width - 1, y), colors[band]) << "row " << y;
+        }
+        g_object_unref(pb);
+    }
+
+    SPDocument *doc = nullptr;
+    gchar *dir = nullptr;
+    std::string filename;
+};
+
+TEST_F(PngWriteTest, StripsAreWrittenInOrder)
+{
+    Geom::Rect const area(0, 0, 10, 1000);
+    ASSERT_EQ(sp_export_png_file(doc, filename.c_str(), area, 10, 1000, 96, 96, 0, nullptr, nullptr, true),
+              EXPORT_OK);
+    expectBands(10, 1000);
+}
+
+TEST_F(PngWriteTest, SingleQueuedStrip)
+{
+    // the renderer has to wait for the writer after every strip
+    Inkscape::Preferences::get()->setInt("/options/exportstrips/value", 1);
+    Geom::Rect const area(0, 0, 10, 1000);
+    ASSERT_EQ(sp_export_png_file(doc, filename.c_str(), area, 30, 2000, 192, 192, 0, nullptr, nullptr, true),
+              EXPORT_OK);
+    expectBands(30, 2000);
+}
+
+TEST_F(PngWriteTest, InterlacedMatchesStriped)
+{
+    Geom::Rect const area(0, 0, 10, 1000);
+    ASSERT_EQ(sp_export_png_file(doc, filename.c_str(), area, 10, 1000, 96, 96, 0, nullptr, nullptr, true,
+                                 std::vector<SPItem *>(), true),
+              EXPORT_OK);
+    expectBands(10, 1000);
+}
+
+TEST_F(PngWriteTest, UnwritableFileFails)
+{
+    std::string const missing = std::string(dir) + G_DIR_SEPARATOR_S + "missing" + G_DIR_SEPARATOR_S + "out.png";
+    Geom::Rect const area(0, 0, 10, 1000);
+    EXPECT_EQ(sp_export_png_file(doc, missing.c_str(), area, 10, 1000, 96, 96, 0, nullptr, nullptr, true),
+              EXPORT_ERROR);
+}
+
+TEST_F(PngWriteTest, SharedDrawingShowsOnlyGivenItems)
+{
+    // one shown document for several exports, as in a batch export of several objects
+    Inkscape::ExportDrawing drawing(doc);
+    Geom::Rect const area(0, 0, 10, 1000);
+    char const *const ids[] = { "red", "blue" };
+    int const rows[] = { 125, 625 };
+
+    for (int i = 0; i < 2; ++i) {
+        std::vector<SPItem *> items{ static_cast<SPItem *>(doc->getObjectById(ids[i])) };
+        ASSERT_NE(items[0], nullptr);
+        ASSERT_EQ(sp_export_png_file(drawing, filename.c_str(), area, 10, 1000, 96, 96, 0, nullptr, nullptr, true,
+                                     items),
+                  EXPORT_OK);
+
+        GdkPixbuf *pb = gdk_pixbuf_new_from_file(filename.c_str(), nullptr);
+        ASSERT_NE(pb, nullptr);
+        for (int j = 0; j < 2; ++j) {
+            guint32 const alpha = pixel_at(pb, 5, rows[j]) & 0xff;
+            EXPECT_EQ(alpha, i == j ? 0xffu : 0u) << ids[i] << " export, row " << rows[j];
+        }
+        g_object_unref(pb);
+    }
+
+    // and the whole document again
+    ASSERT_EQ(sp_export_png_file(drawing, filename.c_str(), area, 10, 1000, 96, 96, 0, nullptr, nullptr, true),
+              EXPORT_OK);
+    expectBands(10, 1000);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
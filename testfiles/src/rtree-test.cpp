@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Test the R-tree used to find items by geometry
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "util/rtree.h"
+
+using Inkscape::Util::RTree;
+
+namespace {
+
+// Boxes scattered over a drawing, like the objects of a busy document
+std::vector<RTree<unsigned>::Entry> random_boxes(unsigned count, unsigned seed = 1)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> pos(0, 10000);
+    std::uniform_real_distribution<double> size(0, 50);
+    std::vector<RTree<unsigned>::Entry> entries;
+    for (unsigned i = 0; i < count; ++i) {
+        Geom::Point p(pos(gen), pos(gen));
+        entries.emplace_back(Geom::Rect(p, p + Geom::Point(size(gen), size(gen))), i);
+    }
+    return entries;
+}
+
+std::vector<unsigned> search(RTree<unsigned> const &tree, Geom::Rect const &area)
+{
+    std::vector<unsigned> found;
+    tree.search(area, [&](unsigned i) { found.push_back(i); });
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+std::vector<unsigned> brute_force(std::vector<RTree<unsigned>::Entry> const &entries, Geom::Rect const &area)
+{
+    std::vector<unsigned> found;
+    for (auto const &entry : entries) {
+        if (entry.first.intersects(area)) {
+            found.push_back(entry.second);
+        }
+    }
+    return found;
+}
+
+}
+
+TEST(RTreeTest, Empty)
+{
+    RTree<unsigned> tree;
+    EXPECT_TRUE(tree.empty());
+    EXPECT_TRUE(search(tree, Geom::Rect(0, 0, 100, 100)).empty());
+
+    tree.build({});
+    EXPECT_TRUE(search(tree, Geom::Rect(0, 0, 100, 100)).empty());
+}
+
+TEST(RTreeTest, SingleEntry)
+{
+    RTree<unsigned> tree;
+    tree.build({{Geom::Rect(10, 10, 20, 20), 7}});
+    EXPECT_EQ(tree.size(), 1u);
+    EXPECT_EQ(search(tree, Geom::Rect(15, 15, 30, 30)), std::vector<unsigned>{7});
+    EXPECT_TRUE(search(tree, Geom::Rect(21, 21, 30, 30)).empty());
+
+    std::vector<unsigned> found;
+    tree.search(Geom::Point(20, 20), [&](unsigned i) { found.push_back(i); });
+    EXPECT_EQ(found, std::vector<unsigned>{7});
+}
+
+TEST(RTreeTest, MatchesBruteForce)
+{
+    // Sizes around the fanout and its powers exercise partial nodes on every level
+    for (unsigned count : {2u, 15u, 16u, 17u, 255u, 256u, 257u, 5000u}) {
+        auto entries = random_boxes(count);
+        RTree<unsigned> tree;
+        tree.build(entries);
+        ASSERT_EQ(tree.size(), count);
+
+        for (auto const &query : random_boxes(50, 2)) {
+            Geom::Rect area = query.first;
+            area.expandBy(100);
+            EXPECT_EQ(search(tree, area), brute_force(entries, area)) << count << " entries";
+        }
+        Geom::Rect everything(-1, -1, 20000, 20000);
+        EXPECT_EQ(search(tree, everything).size(), count);
+    }
+}
+
+TEST(RTreeTest, Rebuild)
+{
+    RTree<unsigned> tree;
+    tree.build(random_boxes(100));
+    tree.build({{Geom::Rect(0, 0, 1, 1), 42}});
+    EXPECT_EQ(search(tree, Geom::Rect(-1, -1, 20000, 20000)), std::vector<unsigned>{42});
+
+    tree.clear();
+    EXPECT_TRUE(tree.empty());
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -36,6 +36,9 @@ rect { fill: green; opacity:1.0; }\
 #id3, #id4 { fill: green; stroke: #606060; }\
 .cls2 { fill: green; opacity:0.5; }\
 </style>\
+<rect id='id1' width='1' height='1'/>\
+<rect id='id3' class='cls1' width='1' height='1'/>\
+<rect id='rect05' class=' cls2  cls1 ' width='1' height='1'/>\
 </svg>";
         doc = SPDocument::createNewDocFromMem(docString, static_cast<int>(strlen(docString)), false);
     }
@@ -71,3 +74,31 @@ TEST_F(ObjectTest, StyleElems) {
         EXPECT_EQ(style->fill.get_value(), Glib::ustring("#008000"));
     }
 }
+
+/*
+ * Test the cascade and selector queries of the style sheets against objects.
+ */
+TEST_F(ObjectTest, StyleSelectors) {
+    ASSERT_TRUE(doc != nullptr);
+
+    SPObject *id1 = doc->getObjectById("id1");
+    SPObject *id3 = doc->getObjectById("id3");
+    SPObject *rect05 = doc->getObjectById("rect05");
+    ASSERT_TRUE(id1 && id3 && rect05);
+
+    // Id beats class and element, whichever sheet it is in.
+    EXPECT_EQ(id1->style->stroke.get_value(), Glib::ustring("#c0c0c0"));
+    EXPECT_EQ(id3->style->fill.get_value(), Glib::ustring("#008000"));
+    EXPECT_EQ(id3->style->stroke.get_value(), Glib::ustring("#606060"));
+
+    // Same specificity: the rule coming later in document order wins.
+    EXPECT_EQ(rect05->style->fill.get_value(), Glib::ustring("#008000"));
+
+    EXPECT_EQ(doc->getObjectsBySelector("rect").size(), 3u);
+    EXPECT_EQ(doc->getObjectsBySelector(".cls1").size(), 2u);
+    EXPECT_EQ(doc->getObjectsBySelector(".cls1.cls2").size(), 1u);
+    EXPECT_EQ(doc->getObjectsBySelector("#id3").size(), 1u);
+    EXPECT_EQ(doc->getObjectsBySelector("svg > rect#id3").size(), 1u);
+    EXPECT_EQ(doc->getObjectsBySelector("circle#id3").size(), 0u);
+    EXPECT_EQ(doc->getObjectsBySelector("#nosuchid").size(), 0u);
+}
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Test reading and writing of SVG path data
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <2geom/pathvector.h>
+
+#include "svg/svg.h"
+
+namespace {
+
+// Path data as found in the wild: exported from editors, hand written, minified.
+std::vector<char const *> const sample_paths = {
+    "M 10,30 A 20,20 0 0 1 50,30 A 20,20 0 0 1 90,30 Q 90,60 50,90 Q 10,60 10,30 z",
+    "m 12.5,0.5 c -6.6,0 -12,5.4 -12,12 0,6.6 5.4,12 12,12 6.6,0 12,-5.4 12,-12 0,-6.6 -5.4,-12 -12,-12 z",
+    "M0 0h24v24H0z M12 2C6.48 2 2 6.48 2 12s4.48 10 10 10 10-4.48 10-10S17.52 2 12 2zm-2 15l-5-5 1.41-1.41L10 14.17l7.59-7.59L19 8l-9 9z",
+    "M3.5.5l-3 3 3 3m5-6l3 3-3 3M7 0L5 7",
+    "M 100,100 L 200,100 L 200,200 L 100,200 Z M 120,120 L 180,120 L 180,180 L 120,180 Z",
+    "M-1.2e-3,4.5E2 l.5.5-.5-.5 T 10 10 t 5 5",
+};
+
+}
+
+TEST(SvgPathTest, ReadEmpty)
+{
+    EXPECT_TRUE(sp_svg_read_pathv(nullptr).empty());
+    EXPECT_TRUE(sp_svg_read_pathv("").empty());
+}
+
+TEST(SvgPathTest, ReadSubpaths)
+{
+    Geom::PathVector pv = sp_svg_read_pathv("M 0,0 L 1,0 L 1,1 z m 5,5 l 1,0 M 9,9 L 10,10");
+    ASSERT_EQ(pv.size(), 3u);
+    EXPECT_TRUE(pv[0].closed());
+    EXPECT_EQ(pv[0].size_open(), 2u);
+    EXPECT_EQ(pv[1].initialPoint(), Geom::Point(5, 5));
+    EXPECT_EQ(pv[1].finalPoint(), Geom::Point(6, 5));
+    EXPECT_FALSE(pv[2].closed());
+
+    // Implicit moveto after closepath
+    pv = sp_svg_read_pathv("M 1,1 L 2,2 z l 2,2 z");
+    ASSERT_EQ(pv.size(), 2u);
+    EXPECT_EQ(pv[1].initialPoint(), Geom::Point(1, 1));
+}
+
+TEST(SvgPathTest, ReadTruncatesAtError)
+{
+    // The segment before the error is still incomplete and dropped
+    Geom::PathVector pv = sp_svg_read_pathv("M 0,0 L 1,1 L 2,2 X 3,3");
+    ASSERT_EQ(pv.size(), 1u);
+    EXPECT_EQ(pv[0].size_open(), 1u);
+}
+
+TEST(SvgPathTest, WriteReadRoundTrip)
+{
+    for (auto d : sample_paths) {
+        Geom::PathVector pv = sp_svg_read_pathv(d);
+        ASSERT_FALSE(pv.empty()) << d;
+
+        gchar *written = sp_svg_write_path(pv);
+        Geom::PathVector reread = sp_svg_read_pathv(written);
+        ASSERT_EQ(reread.size(), pv.size()) << d << " -> " << written;
+        for (size_t i = 0; i < pv.size(); ++i) {
+            EXPECT_EQ(reread[i].size_default(), pv[i].size_default()) << d << " -> " << written;
+            EXPECT_TRUE(Geom::are_near(reread[i].finalPoint(), pv[i].finalPoint(), 1e-5)) << d << " -> " << written;
+        }
+        g_free(written);
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
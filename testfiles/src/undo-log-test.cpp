@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Test compaction of XML undo logs
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "xml/event.h"
+#include "xml/event-fns.h"
+#include "xml/simple-document.h"
+
+using namespace Inkscape::XML;
+
+namespace {
+
+// Path data with one node moved by the given offset
+std::string path_data(int offset)
+{
+    std::string d = "M 0,0";
+    for (int i = 1; i < 500; ++i) {
+        d += " L " + std::to_string(i) + "," + std::to_string(i == 250 ? i + offset : i);
+    }
+    return d;
+}
+
+int count_events(Event const *log)
+{
+    int count = 0;
+    for (; log; log = log->next) {
+        ++count;
+    }
+    return count;
+}
+
+}
+
+class UndoLogTest : public ::testing::Test {
+protected:
+    UndoLogTest()
+    {
+        doc = new SimpleDocument();
+        node = doc->createElement("svg:path");
+        doc->appendChild(node);
+        node->setAttribute("d", path_data(0));
+    }
+
+    // Changes the node's attributes the way a node drag does
+    Event *drag(int from, int to)
+    {
+        doc->beginTransaction();
+        for (int offset = from + 1; offset <= to; ++offset) {
+            node->setAttribute("d", path_data(offset));
+            node->setAttribute("sodipodi:nodetypes", std::string(offset, 'c'));
+        }
+        return doc->commitUndoable();
+    }
+
+    Document *doc;
+    Node *node;
+};
+
+TEST_F(UndoLogTest, CoalesceAttributeChanges)
+{
+    Event *log = drag(0, 10);
+    ASSERT_EQ(count_events(log), 20);
+    std::size_t const full_size = sp_repr_log_memory(log);
+
+    log = sp_repr_compact_log(log);
+    EXPECT_EQ(count_events(log), 2);
+    EXPECT_LT(sp_repr_log_memory(log), full_size / 10);
+
+    sp_repr_undo_log(log);
+    EXPECT_EQ(node->attribute("d"), path_data(0));
+    EXPECT_EQ(node->attribute("sodipodi:nodetypes"), nullptr);
+
+    sp_repr_replay_log(log);
+    EXPECT_EQ(node->attribute("d"), path_data(10));
+    EXPECT_EQ(node->attribute("sodipodi:nodetypes"), std::string(10, 'c'));
+
+    sp_repr_free_log(log);
+}
+
+TEST_F(UndoLogTest, UndoAfterUnloggedChange)
+{
+    Event *log = sp_repr_compact_log(drag(0, 1));
+
+    // Not part of any transaction, so not in the log
+    node->setAttribute("d", "M 0,0 L 1,1");
+
+    sp_repr_undo_log(log);
+    EXPECT_EQ(node->attribute("d"), path_data(0));
+    sp_repr_replay_log(log);
+    EXPECT_EQ(node->attribute("d"), path_data(1));
+
+    sp_repr_free_log(log);
+}
+
+TEST_F(UndoLogTest, CoalesceWithCompactLog)
+{
+    Event *log = sp_repr_compact_log(drag(0, 5));
+    Event *next = drag(5, 8);
+
+    log = sp_repr_compact_log(sp_repr_coalesce_log(log, next));
+    EXPECT_EQ(count_events(log), 2);
+
+    sp_repr_undo_log(log);
+    EXPECT_EQ(node->attribute("d"), path_data(0));
+    sp_repr_replay_log(log);
+    EXPECT_EQ(node->attribute("d"), path_data(8));
+
+    sp_repr_free_log(log);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :